@@ -0,0 +1,262 @@
+#include "simulator.hpp"
+
+// =====================================================================
+static const char *allocation_subsystem_name[ALLOCATION_SUBSYSTEM_TOTAL] = {
+    "trace_reader.dictionary",
+    "trace_reader.strings",
+    "memory.requests"
+};
+
+// =====================================================================
+static uint64_t allocator_round(uint64_t bytes) {
+    return (bytes + ALLOCATOR_HUGE_PAGE_SIZE - 1) & ~(ALLOCATOR_HUGE_PAGE_SIZE - 1);
+};
+
+// =====================================================================
+/// Size of the mapping for a request (small ones on regular pages)
+static uint64_t allocator_map_size(uint64_t bytes) {
+    if (bytes < ALLOCATOR_SMALL_MAP_SIZE) {
+        uint64_t page_size = sysconf(_SC_PAGESIZE);
+        return (bytes + page_size - 1) & ~(page_size - 1);
+    }
+    return allocator_round(bytes);
+};
+
+// =====================================================================
+allocator_t::allocator_t() {
+    this->huge_page_mode = HUGE_PAGE_NONE;
+
+    for (uint32_t i = 0; i < ALLOCATION_SUBSYSTEM_TOTAL; i++) {
+        this->stat_bytes[i] = 0;
+        this->stat_peak_bytes[i] = 0;
+        this->stat_used_bytes[i] = 0;
+        this->stat_peak_used_bytes[i] = 0;
+        this->stat_maps[i] = 0;
+    }
+    this->stat_explicit_huge_pages = 0;
+    this->stat_huge_page_fallbacks = 0;
+};
+
+// =====================================================================
+/// Also called after a new configuration, only new mappings follow it
+void allocator_t::allocate() {
+    this->huge_page_mode = huge_page_mode_t(orcs_engine.config->allocator_huge_pages);
+};
+
+// =====================================================================
+void *allocator_t::map(uint64_t bytes, allocation_subsystem_t subsystem) {
+    uint64_t size = allocator_map_size(bytes);
+    void *address = MAP_FAILED;
+
+    if (bytes < ALLOCATOR_SMALL_MAP_SIZE) {
+        address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ERROR_ASSERT_PRINTF(address != MAP_FAILED, "Could not allocate memory\n");
+    }
+    else if (this->huge_page_mode == HUGE_PAGE_EXPLICIT) {
+        address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (address != MAP_FAILED) {
+            this->stat_explicit_huge_pages++;
+        }
+        else {
+            this->stat_huge_page_fallbacks++;
+        }
+    }
+
+    if (address == MAP_FAILED) {
+        /// Over-map to align the start to a huge page, then trim both ends
+        uint8_t *raw = (uint8_t*)mmap(NULL, size + ALLOCATOR_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ERROR_ASSERT_PRINTF(raw != MAP_FAILED, "Could not allocate memory\n");
+
+        uint8_t *aligned = (uint8_t*)allocator_round((uint64_t)raw);
+        if (aligned > raw) {
+            munmap(raw, aligned - raw);
+        }
+        uint64_t tail = (raw + size + ALLOCATOR_HUGE_PAGE_SIZE) - (aligned + size);
+        if (tail > 0) {
+            munmap(aligned + size, tail);
+        }
+        address = aligned;
+
+        if (this->huge_page_mode != HUGE_PAGE_NONE) {
+            madvise(address, size, MADV_HUGEPAGE);
+        }
+    }
+
+    this->stat_maps[subsystem]++;
+    this->stat_bytes[subsystem] += size;
+    if (this->stat_peak_bytes[subsystem] < this->stat_bytes[subsystem]) {
+        this->stat_peak_bytes[subsystem] = this->stat_bytes[subsystem];
+    }
+    return address;
+};
+
+// =====================================================================
+void allocator_t::unmap(void *address, uint64_t bytes, allocation_subsystem_t subsystem) {
+    uint64_t size = allocator_map_size(bytes);
+    munmap(address, size);
+    this->stat_bytes[subsystem] -= size;
+};
+
+// =====================================================================
+void allocator_t::statistics() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    ORCS_PRINTF("######################################################\n");
+    ORCS_PRINTF("allocator_t\n");
+    ORCS_PRINTF("huge_pages:%u\n", this->huge_page_mode);
+    for (uint32_t i = 0; i < ALLOCATION_SUBSYSTEM_TOTAL; i++) {
+        ORCS_PRINTF("%s_used_bytes:%" PRIu64 "\n", allocation_subsystem_name[i], this->stat_used_bytes[i]);
+        ORCS_PRINTF("%s_peak_used_bytes:%" PRIu64 "\n", allocation_subsystem_name[i], this->stat_peak_used_bytes[i]);
+        ORCS_PRINTF("%s_mapped_bytes:%" PRIu64 "\n", allocation_subsystem_name[i], this->stat_bytes[i]);
+        ORCS_PRINTF("%s_peak_mapped_bytes:%" PRIu64 "\n", allocation_subsystem_name[i], this->stat_peak_bytes[i]);
+        ORCS_PRINTF("%s_maps:%" PRIu64 "\n", allocation_subsystem_name[i], this->stat_maps[i]);
+    }
+    ORCS_PRINTF("explicit_huge_page_maps:%" PRIu64 "\n", this->stat_explicit_huge_pages);
+    ORCS_PRINTF("huge_page_fallbacks:%" PRIu64 "\n", this->stat_huge_page_fallbacks);
+    ORCS_PRINTF("peak_rss_bytes:%" PRIu64 "\n", (uint64_t)usage.ru_maxrss * 1024);
+};
+
+// =====================================================================
+arena_t::arena_t() {
+    this->subsystem = ALLOCATION_TRACE_DICTIONARY;
+    this->chunk = NULL;
+    this->chunk_used = 0;
+    this->stat_used = 0;
+};
+
+// =====================================================================
+arena_t::~arena_t() {
+    this->release();
+};
+
+// =====================================================================
+void arena_t::allocate(allocation_subsystem_t arena_subsystem) {
+    this->release();
+    this->subsystem = arena_subsystem;
+};
+
+// =====================================================================
+void arena_t::release() {
+    while (this->chunk != NULL) {
+        arena_chunk_t *previous = this->chunk->previous;
+        orcs_engine.allocator->unmap(this->chunk, this->chunk->size, this->subsystem);
+        this->chunk = previous;
+    }
+    if (this->stat_used > 0) {
+        orcs_engine.allocator->remove_used(this->stat_used, this->subsystem);
+    }
+    this->chunk_used = 0;
+    this->stat_used = 0;
+};
+
+// =====================================================================
+/// Zero filled. A request that does not fit opens a new chunk (large
+/// requests get a chunk of their own size), the rest of the old chunk
+/// is not used anymore.
+void *arena_t::allocate_bytes(uint64_t bytes, uint64_t alignment) {
+    uint64_t offset = (this->chunk_used + alignment - 1) & ~(alignment - 1);
+
+    if (this->chunk == NULL || offset + bytes > this->chunk->size) {
+        uint64_t chunk_size = ARENA_FIRST_CHUNK_SIZE;
+        if (this->chunk != NULL && this->chunk->size < ARENA_CHUNK_SIZE) {
+            chunk_size = this->chunk->size * 2;
+        }
+        else if (this->chunk != NULL) {
+            chunk_size = ARENA_CHUNK_SIZE;
+        }
+        uint64_t size = sizeof(arena_chunk_t) + alignment + bytes;
+        if (size < chunk_size) {
+            size = chunk_size;
+        }
+        arena_chunk_t *new_chunk = (arena_chunk_t*)orcs_engine.allocator->map(size, this->subsystem);
+        new_chunk->previous = this->chunk;
+        new_chunk->size = size;
+        this->chunk = new_chunk;
+        offset = (sizeof(arena_chunk_t) + alignment - 1) & ~(alignment - 1);
+    }
+
+    this->chunk_used = offset + bytes;
+    this->stat_used += bytes;
+    orcs_engine.allocator->add_used(bytes, this->subsystem);
+    return (uint8_t*)this->chunk + offset;
+};
+
+// =====================================================================
+/// FNV-1a
+static uint32_t string_table_hash(const char *string) {
+    uint32_t hash = 2166136261u;
+    for (; *string != '\0'; string++) {
+        hash = (hash ^ (uint8_t)*string) * 16777619u;
+    }
+    return hash;
+};
+
+// =====================================================================
+string_table_t::string_table_t() {
+    this->slot = NULL;
+    this->table_size = 0;
+    this->total_strings = 0;
+};
+
+// =====================================================================
+string_table_t::~string_table_t() {
+    delete[] this->slot;
+};
+
+// =====================================================================
+void string_table_t::allocate(allocation_subsystem_t subsystem) {
+    this->arena.allocate(subsystem);
+
+    delete[] this->slot;
+    this->table_size = STRING_TABLE_INITIAL_SIZE;
+    this->total_strings = 0;
+    this->slot = new const char*[this->table_size];
+    ERROR_ASSERT_PRINTF(this->slot != NULL, "Could not allocate memory\n");
+    memset(this->slot, 0, sizeof(const char*) * this->table_size);
+};
+
+// =====================================================================
+void string_table_t::grow() {
+    const char **old_slot = this->slot;
+    uint32_t old_size = this->table_size;
+
+    this->table_size *= 2;
+    this->slot = new const char*[this->table_size];
+    ERROR_ASSERT_PRINTF(this->slot != NULL, "Could not allocate memory\n");
+    memset(this->slot, 0, sizeof(const char*) * this->table_size);
+
+    for (uint32_t i = 0; i < old_size; i++) {
+        if (old_slot[i] != NULL) {
+            uint32_t position = string_table_hash(old_slot[i]) & (this->table_size - 1);
+            while (this->slot[position] != NULL) {
+                position = (position + 1) & (this->table_size - 1);
+            }
+            this->slot[position] = old_slot[i];
+        }
+    }
+    delete[] old_slot;
+};
+
+// =====================================================================
+const char *string_table_t::intern(const char *string) {
+    uint32_t position = string_table_hash(string) & (this->table_size - 1);
+    while (this->slot[position] != NULL) {
+        if (strcmp(this->slot[position], string) == 0) {
+            return this->slot[position];
+        }
+        position = (position + 1) & (this->table_size - 1);
+    }
+
+    uint64_t length = strlen(string) + 1;
+    char *copy = (char*)this->arena.allocate_bytes(length, 1);
+    memcpy(copy, string, length);
+    this->slot[position] = copy;
+    this->total_strings++;
+
+    /// Keep the load under 1/2
+    if (this->total_strings * 2 > this->table_size) {
+        this->grow();
+    }
+    return copy;
+};
@@ -0,0 +1,222 @@
+// ============================================================================
+// ============================================================================
+/// Arena and pool allocation.
+/// Both take their memory from allocator_t::map(): anonymous mappings,
+/// 2MB aligned and rounded to 2MB, so they can be backed by huge pages.
+/// Mappings under ALLOCATOR_SMALL_MAP_SIZE (e.g. a 64-entry request pool)
+/// stay on regular pages, a huge page would be mostly empty.
+/// allocator.huge_pages selects the backing:
+///     0   regular pages
+///     1   transparent huge pages (madvise MADV_HUGEPAGE)
+///     2   explicit huge pages (MAP_HUGETLB), falling back to 1 when the
+///         system has none reserved (see /proc/sys/vm/nr_hugepages)
+///
+/// arena_t         Bump allocation in chunks, for long-lived read-mostly
+///                 data (the static dictionary), released all at once.
+///                 Chunks double from ARENA_FIRST_CHUNK_SIZE up to
+///                 ARENA_CHUNK_SIZE, so small arenas stay small.
+/// string_table_t  Interned strings kept in an arena.
+/// pool_t<T>       Fixed number of T plus a stack of free indexes, for
+///                 transient objects. T must be plain data, checkpoints
+///                 copy it as raw bytes.
+///
+/// allocator_t accounts the mapped bytes of each subsystem and the bytes
+/// its arenas and pools actually hand out; statistics() reports both with
+/// the peak RSS of the process.
+#define ALLOCATOR_HUGE_PAGE_SIZE (2ULL << 20)
+#define ALLOCATOR_SMALL_MAP_SIZE (ALLOCATOR_HUGE_PAGE_SIZE / 2)
+#define ARENA_CHUNK_SIZE ALLOCATOR_HUGE_PAGE_SIZE
+#define ARENA_FIRST_CHUNK_SIZE (64ULL << 10)
+#define STRING_TABLE_INITIAL_SIZE 1024      /// Power of two
+
+// ============================================================================
+enum huge_page_mode_t {
+    HUGE_PAGE_NONE,
+    HUGE_PAGE_TRANSPARENT,
+    HUGE_PAGE_EXPLICIT
+};
+
+// ============================================================================
+enum allocation_subsystem_t {
+    ALLOCATION_TRACE_DICTIONARY,
+    ALLOCATION_TRACE_STRINGS,
+    ALLOCATION_MEMORY_REQUESTS,
+    ALLOCATION_SUBSYSTEM_TOTAL
+};
+
+// ============================================================================
+class allocator_t {
+    private:
+        huge_page_mode_t huge_page_mode;
+
+        uint64_t stat_bytes[ALLOCATION_SUBSYSTEM_TOTAL];        /// Mapped now
+        uint64_t stat_peak_bytes[ALLOCATION_SUBSYSTEM_TOTAL];
+        uint64_t stat_used_bytes[ALLOCATION_SUBSYSTEM_TOTAL];   /// Handed out now
+        uint64_t stat_peak_used_bytes[ALLOCATION_SUBSYSTEM_TOTAL];
+        uint64_t stat_maps[ALLOCATION_SUBSYSTEM_TOTAL];
+        uint64_t stat_explicit_huge_pages;                      /// Mappings on MAP_HUGETLB
+        uint64_t stat_huge_page_fallbacks;                      /// MAP_HUGETLB failed
+
+    public:
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        allocator_t();
+        void allocate();
+        void statistics();
+
+        /// Zero filled
+        void *map(uint64_t bytes, allocation_subsystem_t subsystem);
+        void unmap(void *address, uint64_t bytes, allocation_subsystem_t subsystem);
+
+        /// Bytes in use inside the mappings, kept by arenas and pools
+        void add_used(uint64_t bytes, allocation_subsystem_t subsystem) {
+            this->stat_used_bytes[subsystem] += bytes;
+            if (this->stat_peak_used_bytes[subsystem] < this->stat_used_bytes[subsystem]) {
+                this->stat_peak_used_bytes[subsystem] = this->stat_used_bytes[subsystem];
+            }
+        };
+        void remove_used(uint64_t bytes, allocation_subsystem_t subsystem) {
+            this->stat_used_bytes[subsystem] -= bytes;
+        };
+};
+
+// ============================================================================
+/// Each chunk starts with its header
+struct arena_chunk_t {
+    arena_chunk_t *previous;
+    uint64_t size;
+};
+
+class arena_t {
+    private:
+        allocation_subsystem_t subsystem;
+        arena_chunk_t *chunk;           /// Current chunk, linked to the older ones
+        uint64_t chunk_used;
+
+    public:
+        uint64_t stat_used;             /// Bytes handed out
+
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        arena_t();
+        ~arena_t();
+        void allocate(allocation_subsystem_t arena_subsystem);
+        void release();
+        void *allocate_bytes(uint64_t bytes, uint64_t alignment);
+
+        /// Constructed in place, never destroyed
+        template <class T>
+        T *allocate_array(uint64_t count) {
+            T *array = (T*)this->allocate_bytes(sizeof(T) * count, __alignof__(T));
+            for (uint64_t i = 0; i < count; i++) {
+                new (&array[i]) T();
+            }
+            return array;
+        };
+};
+
+// ============================================================================
+class string_table_t {
+    private:
+        arena_t arena;
+        const char **slot;              /// Open addressing, linear probing
+        uint32_t table_size;
+        uint32_t total_strings;
+
+        void grow();
+
+    public:
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        string_table_t();
+        ~string_table_t();
+        void allocate(allocation_subsystem_t subsystem);
+
+        /// The same text always returns the same pointer
+        const char *intern(const char *string);
+
+        uint32_t get_total_strings() {
+            return this->total_strings;
+        };
+};
+
+// ============================================================================
+template <class T>
+class pool_t {
+    private:
+        allocation_subsystem_t subsystem;
+        T *object;
+        uint32_t *free_index;           /// Stack of free objects
+        uint32_t total_free;
+        uint32_t capacity;
+
+        uint64_t map_bytes() {
+            return sizeof(T) * this->capacity + sizeof(uint32_t) * this->capacity;
+        };
+
+    public:
+        pool_t() {
+            this->object = NULL;
+            this->free_index = NULL;
+            this->total_free = 0;
+            this->capacity = 0;
+        };
+        ~pool_t() {
+            this->release_all();
+        };
+
+        void allocate(uint32_t pool_capacity, allocation_subsystem_t pool_subsystem) {
+            this->release_all();
+            this->subsystem = pool_subsystem;
+            this->capacity = pool_capacity;
+            this->object = (T*)orcs_engine.allocator->map(this->map_bytes(), this->subsystem);
+            orcs_engine.allocator->add_used(this->map_bytes(), this->subsystem);
+            this->free_index = (uint32_t*)(this->object + pool_capacity);
+
+            /// Index 0 on top
+            for (uint32_t i = 0; i < pool_capacity; i++) {
+                this->free_index[i] = pool_capacity - 1 - i;
+            }
+            this->total_free = pool_capacity;
+        };
+
+        void release_all() {
+            if (this->object != NULL) {
+                orcs_engine.allocator->unmap(this->object, this->map_bytes(), this->subsystem);
+                orcs_engine.allocator->remove_used(this->map_bytes(), this->subsystem);
+            }
+            this->object = NULL;
+            this->free_index = NULL;
+            this->total_free = 0;
+        };
+
+        bool is_empty() {
+            return this->total_free == 0;
+        };
+
+        /// The pool must not be empty
+        uint32_t acquire() {
+            return this->free_index[--this->total_free];
+        };
+
+        void release(uint32_t index) {
+            this->free_index[this->total_free++] = index;
+        };
+
+        T &operator[](uint32_t index) {
+            return this->object[index];
+        };
+
+        uint32_t get_capacity() {
+            return this->capacity;
+        };
+
+        void checkpoint(checkpoint_t *checkpoint) {
+            checkpoint->transfer(this->object, sizeof(T) * this->capacity);
+            checkpoint->transfer(this->free_index, sizeof(uint32_t) * this->capacity);
+            checkpoint->transfer(&this->total_free);
+        };
+};
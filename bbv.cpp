@@ -0,0 +1,423 @@
+#include "simulator.hpp"
+
+#include <cmath>
+
+// =====================================================================
+static uint64_t bbv_hash(uint64_t value) {
+    /// splitmix64
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+};
+
+// =====================================================================
+/// Uniform in [-1, 1], fixed for each (bbl, dimension)
+static double bbv_projection_value(uint32_t bbl, uint32_t dimension) {
+    uint64_t random = bbv_hash(BBV_RANDOM_SEED ^ ((uint64_t)bbl * BBV_DIMENSIONS + dimension));
+    return (double)(random >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+};
+
+// =====================================================================
+static double bbv_distance(const double *a, const double *b) {
+    double distance = 0;
+    for (uint32_t d = 0; d < BBV_DIMENSIONS; d++) {
+        distance += (a[d] - b[d]) * (a[d] - b[d]);
+    }
+    return distance;
+};
+
+// =====================================================================
+bbv_t::bbv_t() {
+    this->interval_size = 0;
+    this->total_bbls = 0;
+    this->bbl_count = NULL;
+    this->touched_bbl = NULL;
+    this->total_touched = 0;
+    this->interval_instructions = 0;
+
+    this->total_intervals = 0;
+    this->max_intervals = 0;
+    this->projection = NULL;
+    this->interval_start = NULL;
+    this->interval_length = NULL;
+
+    this->total_instructions = 0;
+    this->bb_file = NULL;
+};
+
+// =====================================================================
+bbv_t::~bbv_t() {
+    delete[] this->bbl_count;
+    delete[] this->touched_bbl;
+    delete[] this->projection;
+    delete[] this->interval_start;
+    delete[] this->interval_length;
+    if (this->bb_file != NULL) {
+        fclose(this->bb_file);
+    }
+};
+
+// =====================================================================
+void bbv_t::allocate(uint64_t interval_instructions, const char *output_basename) {
+    char file_name[TRACE_LINE_SIZE];
+
+    ERROR_ASSERT_PRINTF(interval_instructions > 0, "BBV interval must be greater than zero.\n");
+    this->interval_size = interval_instructions;
+    this->total_bbls = orcs_engine.trace_reader->get_binary_total_bbls();
+
+    this->bbl_count = new uint64_t[this->total_bbls];
+    this->touched_bbl = new uint32_t[this->total_bbls];
+    ERROR_ASSERT_PRINTF(this->bbl_count != NULL && this->touched_bbl != NULL, "Could not allocate memory\n");
+    for (uint32_t bbl = 0; bbl < this->total_bbls; bbl++) {
+        this->bbl_count[bbl] = 0;
+    }
+
+    snprintf(file_name, sizeof(file_name), "%s.bb", output_basename);
+    this->bb_file = fopen(file_name, "w");
+    ERROR_ASSERT_PRINTF(this->bb_file != NULL, "Could not open the BBV file.\n%s\n", file_name);
+};
+
+// =====================================================================
+void bbv_t::close_interval() {
+    /// Grow the interval storage (doubling)
+    if (this->total_intervals == this->max_intervals) {
+        uint64_t new_max = (this->max_intervals == 0) ? 1024 : this->max_intervals * 2;
+        double *new_projection = new double[new_max * BBV_DIMENSIONS];
+        uint64_t *new_start = new uint64_t[new_max];
+        uint64_t *new_length = new uint64_t[new_max];
+        ERROR_ASSERT_PRINTF(new_projection != NULL && new_start != NULL && new_length != NULL, "Could not allocate memory\n");
+
+        if (this->total_intervals > 0) {
+            memcpy(new_projection, this->projection, sizeof(double) * this->total_intervals * BBV_DIMENSIONS);
+            memcpy(new_start, this->interval_start, sizeof(uint64_t) * this->total_intervals);
+            memcpy(new_length, this->interval_length, sizeof(uint64_t) * this->total_intervals);
+        }
+        delete[] this->projection;
+        delete[] this->interval_start;
+        delete[] this->interval_length;
+        this->projection = new_projection;
+        this->interval_start = new_start;
+        this->interval_length = new_length;
+        this->max_intervals = new_max;
+    }
+
+    /// Normalized vector projected to BBV_DIMENSIONS, and the .bb line
+    double *vector = &this->projection[this->total_intervals * BBV_DIMENSIONS];
+    for (uint32_t d = 0; d < BBV_DIMENSIONS; d++) {
+        vector[d] = 0;
+    }
+
+    fprintf(this->bb_file, "T");
+    for (uint32_t i = 0; i < this->total_touched; i++) {
+        uint32_t bbl = this->touched_bbl[i];
+        double frequency = (double)this->bbl_count[bbl] / this->interval_instructions;
+        for (uint32_t d = 0; d < BBV_DIMENSIONS; d++) {
+            vector[d] += frequency * bbv_projection_value(bbl, d);
+        }
+        fprintf(this->bb_file, ":%u:%" PRIu64 " ", bbl, this->bbl_count[bbl]);
+        this->bbl_count[bbl] = 0;
+    }
+    fprintf(this->bb_file, "\n");
+
+    this->interval_start[this->total_intervals] = this->total_instructions;
+    this->interval_length[this->total_intervals] = this->interval_instructions;
+    this->total_intervals++;
+
+    this->total_instructions += this->interval_instructions;
+    this->interval_instructions = 0;
+    this->total_touched = 0;
+};
+
+// =====================================================================
+/// Walk the dynamic trace only, the memory trace is not needed
+void bbv_t::run() {
+    trace_reader_t *trace_reader = orcs_engine.trace_reader;
+    uint32_t bbl;
+
+    while (trace_reader->trace_next_dynamic(&bbl)) {
+        ERROR_ASSERT_PRINTF(bbl < this->total_bbls, "Dynamic BBL %u out of the static trace.\n", bbl);
+
+        if (this->bbl_count[bbl] == 0) {
+            this->touched_bbl[this->total_touched++] = bbl;
+        }
+        uint32_t size = trace_reader->get_bbl_size(bbl);
+        this->bbl_count[bbl] += size;
+        this->interval_instructions += size;
+
+        if (this->interval_instructions >= this->interval_size) {
+            this->close_interval();
+        }
+    }
+
+    if (this->interval_instructions > 0) {
+        this->close_interval();
+    }
+    fflush(this->bb_file);
+};
+
+// =====================================================================
+/// K-means with k-means++ seeding. Returns the distortion (sum of the
+/// squared distances to the centroids).
+double bbv_t::kmeans(uint32_t k, uint64_t seed, uint32_t *assignment, double *centroid) {
+    uint64_t total = this->total_intervals;
+    double *distance = new double[total];
+    uint32_t *cluster_size = new uint32_t[k];
+    ERROR_ASSERT_PRINTF(distance != NULL && cluster_size != NULL, "Could not allocate memory\n");
+
+    /// Seeding
+    uint64_t random = seed;
+    uint64_t first = bbv_hash(random++) % total;
+    memcpy(&centroid[0], &this->projection[first * BBV_DIMENSIONS], sizeof(double) * BBV_DIMENSIONS);
+    for (uint64_t i = 0; i < total; i++) {
+        distance[i] = bbv_distance(&this->projection[i * BBV_DIMENSIONS], &centroid[0]);
+    }
+    for (uint32_t c = 1; c < k; c++) {
+        double sum = 0;
+        for (uint64_t i = 0; i < total; i++) {
+            sum += distance[i];
+        }
+        double target = (double)(bbv_hash(random++) >> 11) / 9007199254740992.0 * sum;
+        uint64_t chosen = total - 1;
+        for (uint64_t i = 0; i < total; i++) {
+            target -= distance[i];
+            if (target <= 0 && distance[i] > 0) {
+                chosen = i;
+                break;
+            }
+        }
+        memcpy(&centroid[c * BBV_DIMENSIONS], &this->projection[chosen * BBV_DIMENSIONS], sizeof(double) * BBV_DIMENSIONS);
+        for (uint64_t i = 0; i < total; i++) {
+            double new_distance = bbv_distance(&this->projection[i * BBV_DIMENSIONS], &centroid[c * BBV_DIMENSIONS]);
+            if (new_distance < distance[i]) {
+                distance[i] = new_distance;
+            }
+        }
+    }
+
+    /// Lloyd iterations
+    double distortion = 0;
+    for (uint64_t i = 0; i < total; i++) {
+        assignment[i] = UINT32_MAX;
+    }
+    for (uint32_t iteration = 0; iteration < BBV_KMEANS_ITERATIONS; iteration++) {
+        bool changed = false;
+        distortion = 0;
+        for (uint64_t i = 0; i < total; i++) {
+            uint32_t best = 0;
+            double best_distance = bbv_distance(&this->projection[i * BBV_DIMENSIONS], &centroid[0]);
+            for (uint32_t c = 1; c < k; c++) {
+                double new_distance = bbv_distance(&this->projection[i * BBV_DIMENSIONS], &centroid[c * BBV_DIMENSIONS]);
+                if (new_distance < best_distance) {
+                    best = c;
+                    best_distance = new_distance;
+                }
+            }
+            changed |= (assignment[i] != best);
+            assignment[i] = best;
+            distortion += best_distance;
+        }
+        if (!changed) {
+            break;
+        }
+
+        for (uint32_t c = 0; c < k; c++) {
+            cluster_size[c] = 0;
+        }
+        for (uint64_t i = 0; i < (uint64_t)k * BBV_DIMENSIONS; i++) {
+            centroid[i] = 0;
+        }
+        for (uint64_t i = 0; i < total; i++) {
+            cluster_size[assignment[i]]++;
+            for (uint32_t d = 0; d < BBV_DIMENSIONS; d++) {
+                centroid[assignment[i] * BBV_DIMENSIONS + d] += this->projection[i * BBV_DIMENSIONS + d];
+            }
+        }
+        for (uint32_t c = 0; c < k; c++) {
+            for (uint32_t d = 0; d < BBV_DIMENSIONS && cluster_size[c] > 0; d++) {
+                centroid[c * BBV_DIMENSIONS + d] /= cluster_size[c];
+            }
+        }
+    }
+
+    delete[] distance;
+    delete[] cluster_size;
+    return distortion;
+};
+
+// =====================================================================
+/// Bayesian Information Criterion of a clustering (spherical Gaussians,
+/// as in X-means and SimPoint). Higher is better.
+double bbv_t::bic(uint32_t k, uint32_t *assignment, double distortion) {
+    double points = this->total_intervals;
+    double dimensions = BBV_DIMENSIONS;
+
+    if (points <= k) {
+        return -HUGE_VAL;
+    }
+    double variance = distortion / (dimensions * (points - k));
+    if (variance < 1e-12) {
+        variance = 1e-12;
+    }
+
+    uint32_t *cluster_size = new uint32_t[k];
+    ERROR_ASSERT_PRINTF(cluster_size != NULL, "Could not allocate memory\n");
+    for (uint32_t c = 0; c < k; c++) {
+        cluster_size[c] = 0;
+    }
+    for (uint64_t i = 0; i < this->total_intervals; i++) {
+        cluster_size[assignment[i]]++;
+    }
+
+    double likelihood = -(points * dimensions / 2.0) * log(2.0 * M_PI * variance) - dimensions * (points - k) / 2.0;
+    for (uint32_t c = 0; c < k; c++) {
+        if (cluster_size[c] > 0) {
+            likelihood += cluster_size[c] * log(cluster_size[c] / points);
+        }
+    }
+    delete[] cluster_size;
+
+    double parameters = (k - 1) + k * dimensions + 1;
+    return likelihood - parameters / 2.0 * log(points);
+};
+
+// =====================================================================
+/// Cluster the intervals for k = 1..BBV_MAX_K, pick the smallest k
+/// whose BIC reaches BBV_BIC_THRESHOLD of the observed BIC range and
+/// write the interval closest to each centroid as its simulation point.
+void bbv_t::simpoints(const char *output_basename) {
+    char file_name[TRACE_LINE_SIZE];
+    uint64_t total = this->total_intervals;
+    ERROR_ASSERT_PRINTF(total > 0, "No intervals to cluster.\n");
+
+    /// BIC is undefined with one cluster per interval (no variance left)
+    uint32_t max_k = (total - 1 < BBV_MAX_K) ? total - 1 : BBV_MAX_K;
+    if (max_k == 0) {
+        max_k = 1;
+    }
+    double bic_score[BBV_MAX_K + 1];
+    uint64_t best_seed[BBV_MAX_K + 1];
+
+    uint32_t *assignment = new uint32_t[total];
+    double *centroid = new double[BBV_MAX_K * BBV_DIMENSIONS];
+    ERROR_ASSERT_PRINTF(assignment != NULL && centroid != NULL, "Could not allocate memory\n");
+
+    double min_bic = HUGE_VAL;
+    double max_bic = -HUGE_VAL;
+    for (uint32_t k = 1; k <= max_k; k++) {
+        double best_distortion = HUGE_VAL;
+        for (uint32_t s = 0; s < BBV_KMEANS_SEEDS; s++) {
+            uint64_t seed = BBV_RANDOM_SEED + k * BBV_KMEANS_SEEDS + s;
+            double distortion = this->kmeans(k, seed, assignment, centroid);
+            if (distortion < best_distortion) {
+                best_distortion = distortion;
+                best_seed[k] = seed;
+                bic_score[k] = this->bic(k, assignment, distortion);
+            }
+        }
+        if (!std::isfinite(bic_score[k])) {
+            continue;
+        }
+        if (bic_score[k] < min_bic) {
+            min_bic = bic_score[k];
+        }
+        if (bic_score[k] > max_bic) {
+            max_bic = bic_score[k];
+        }
+    }
+
+    /// Without any finite score (a single interval) there is one cluster
+    if (min_bic > max_bic) {
+        min_bic = 0.0;
+        max_bic = 0.0;
+    }
+    uint32_t chosen_k = 1;
+    for (uint32_t k = 1; k <= max_k; k++) {
+        if (std::isfinite(bic_score[k]) && bic_score[k] >= min_bic + BBV_BIC_THRESHOLD * (max_bic - min_bic)) {
+            chosen_k = k;
+            break;
+        }
+    }
+    /// Same seed, same clustering
+    this->kmeans(chosen_k, best_seed[chosen_k], assignment, centroid);
+
+    /// Representative interval and weight (by instructions) of each cluster
+    uint64_t representative[BBV_MAX_K];
+    double representative_distance[BBV_MAX_K];
+    uint64_t cluster_instructions[BBV_MAX_K];
+    for (uint32_t c = 0; c < chosen_k; c++) {
+        representative[c] = UINT64_MAX;
+        representative_distance[c] = HUGE_VAL;
+        cluster_instructions[c] = 0;
+    }
+    for (uint64_t i = 0; i < total; i++) {
+        uint32_t c = assignment[i];
+        double distance = bbv_distance(&this->projection[i * BBV_DIMENSIONS], &centroid[c * BBV_DIMENSIONS]);
+        if (distance < representative_distance[c]) {
+            representative[c] = i;
+            representative_distance[c] = distance;
+        }
+        cluster_instructions[c] += this->interval_length[i];
+    }
+
+    snprintf(file_name, sizeof(file_name), "%s.simpoints", output_basename);
+    FILE *simpoints_file = fopen(file_name, "w");
+    ERROR_ASSERT_PRINTF(simpoints_file != NULL, "Could not open the simpoints file.\n%s\n", file_name);
+    snprintf(file_name, sizeof(file_name), "%s.weights", output_basename);
+    FILE *weights_file = fopen(file_name, "w");
+    ERROR_ASSERT_PRINTF(weights_file != NULL, "Could not open the weights file.\n%s\n", file_name);
+    snprintf(file_name, sizeof(file_name), "%s.regions", output_basename);
+    FILE *regions_file = fopen(file_name, "w");
+    ERROR_ASSERT_PRINTF(regions_file != NULL, "Could not open the regions file.\n%s\n", file_name);
+
+    fprintf(regions_file, "# start_instruction length weight cluster\n");
+    for (uint32_t c = 0; c < chosen_k; c++) {
+        if (representative[c] == UINT64_MAX) {
+            continue;
+        }
+        uint64_t i = representative[c];
+        double weight = (double)cluster_instructions[c] / this->total_instructions;
+        fprintf(simpoints_file, "%" PRIu64 " %u\n", i, c);
+        fprintf(weights_file, "%.6f %u\n", weight, c);
+        fprintf(regions_file, "%" PRIu64 " %" PRIu64 " %.6f %u\n", this->interval_start[i], this->interval_length[i], weight, c);
+    }
+    fclose(simpoints_file);
+    fclose(weights_file);
+    fclose(regions_file);
+
+    ORCS_PRINTF("SimPoints: %u clusters (BIC %.2f, range [%.2f, %.2f]) => %s.regions\n",
+                    chosen_k, std::isfinite(bic_score[chosen_k]) ? bic_score[chosen_k] : 0.0, min_bic, max_bic, output_basename);
+
+    delete[] assignment;
+    delete[] centroid;
+};
+
+// =====================================================================
+/// Read the region <index> of a .regions file
+void bbv_t::read_region(const char *region_file_name, uint32_t index, uint64_t *start, uint64_t *length) {
+    char file_line[TRACE_LINE_SIZE];
+    uint32_t region = 0;
+
+    FILE *region_file = fopen(region_file_name, "r");
+    ERROR_ASSERT_PRINTF(region_file != NULL, "Could not open the regions file.\n%s\n", region_file_name);
+    while (fgets(file_line, sizeof(file_line), region_file) != NULL) {
+        if (file_line[0] == '#' || file_line[0] == '\n') {
+            continue;
+        }
+        if (region++ == index) {
+            ERROR_ASSERT_PRINTF(sscanf(file_line, "%" SCNu64 " %" SCNu64, start, length) == 2, "Malformed region line: %s\n", file_line);
+            fclose(region_file);
+            return;
+        }
+    }
+    ERROR_PRINTF("Region %u not found (%u regions).\n%s\n", index, region, region_file_name);
+};
+
+// =====================================================================
+void bbv_t::statistics() {
+    ORCS_PRINTF("######################################################\n");
+    ORCS_PRINTF("bbv_t\n");
+    ORCS_PRINTF("interval_size:%" PRIu64 "\n", this->interval_size);
+    ORCS_PRINTF("intervals:%" PRIu64 "\n", this->total_intervals);
+    ORCS_PRINTF("instructions:%" PRIu64 "\n", this->total_instructions);
+};
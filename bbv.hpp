@@ -0,0 +1,62 @@
+// ============================================================================
+// ============================================================================
+/// Basic-block vectors and SimPoint selection.
+/// Each interval of ~interval_size instructions accumulates, for every
+/// BBL executed, its instruction count (executions * BBL size). The
+/// accumulator is one dense counter per static BBL plus the list of the
+/// BBLs touched in the interval, so closing an interval costs only the
+/// BBLs it used. Each interval is kept as a random projection to
+/// BBV_DIMENSIONS, so memory does not grow with the number of BBLs.
+///
+/// Outputs (<basename> defaults to the trace name):
+///     <basename>.bb           Frequency vectors (SimPoint format)
+///     <basename>.simpoints    "interval cluster" (SimPoint format)
+///     <basename>.weights      "weight cluster" (SimPoint format)
+///     <basename>.regions      "start_instruction length weight cluster",
+///                             consumed by --region_file/--region_index
+#define BBV_DIMENSIONS 15
+#define BBV_MAX_K 30
+#define BBV_KMEANS_SEEDS 5
+#define BBV_KMEANS_ITERATIONS 100
+#define BBV_BIC_THRESHOLD 0.9
+#define BBV_RANDOM_SEED 0x4f7243532d425656ULL
+
+// ============================================================================
+class bbv_t {
+    private:
+        uint64_t interval_size;
+        uint32_t total_bbls;
+
+        /// Sparse accumulator for the current interval
+        uint64_t *bbl_count;        /// Instructions per BBL
+        uint32_t *touched_bbl;      /// BBLs with bbl_count != 0
+        uint32_t total_touched;
+        uint64_t interval_instructions;
+
+        /// Closed intervals
+        uint64_t total_intervals;
+        uint64_t max_intervals;
+        double *projection;         /// total_intervals * BBV_DIMENSIONS
+        uint64_t *interval_start;   /// First instruction of each interval
+        uint64_t *interval_length;
+
+        uint64_t total_instructions;
+        FILE *bb_file;
+
+        void close_interval();
+        double kmeans(uint32_t k, uint64_t seed, uint32_t *assignment, double *centroid);
+        double bic(uint32_t k, uint32_t *assignment, double distortion);
+
+    public:
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        bbv_t();
+        ~bbv_t();
+        void allocate(uint64_t interval_instructions, const char *output_basename);
+        void run();
+        void simpoints(const char *output_basename);
+        void statistics();
+
+        static void read_region(const char *region_file_name, uint32_t index, uint64_t *start, uint64_t *length);
+};
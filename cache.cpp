@@ -0,0 +1,137 @@
+#include "simulator.hpp"
+
+// =====================================================================
+cache_t::cache_t() {
+    this->total_sets = 0;
+    this->associativity = 0;
+    this->line_size = 0;
+    this->lines = NULL;
+    this->access_stamp = 0;
+
+    this->stat_accesses = 0;
+    this->stat_hits = 0;
+    this->stat_misses = 0;
+    this->stat_prefetch_unused = 0;
+};
+
+// =====================================================================
+cache_t::~cache_t() {
+    delete[] this->lines;
+};
+
+// =====================================================================
+void cache_t::allocate(uint32_t sets, uint32_t ways, uint32_t line_bytes) {
+    ERROR_ASSERT_PRINTF(sets > 0 && (sets & (sets - 1)) == 0, "Cache sets (%u) must be a power of two.\n", sets);
+
+    delete[] this->lines;
+    this->total_sets = sets;
+    this->associativity = ways;
+    this->line_size = line_bytes;
+    this->lines = new cache_line_t[sets * ways];
+    ERROR_ASSERT_PRINTF(this->lines != NULL, "Could not allocate memory\n");
+
+    for (uint32_t i = 0; i < sets * ways; i++) {
+        this->lines[i].tag = CACHE_INVALID_TAG;
+        this->lines[i].last_access = 0;
+        this->lines[i].prefetch_stamp = 0;
+    }
+    this->access_stamp = 0;
+};
+
+// =====================================================================
+bool cache_t::has_geometry(uint32_t sets, uint32_t ways, uint32_t line_bytes) {
+    return this->lines != NULL && this->total_sets == sets && this->associativity == ways && this->line_size == line_bytes;
+};
+
+// =====================================================================
+/// Returns the line holding the address or NULL and the LRU victim
+cache_line_t *cache_t::find_line(uint64_t address, cache_line_t **victim) {
+    uint64_t tag = address / this->line_size;
+    cache_line_t *set = &this->lines[(tag & (this->total_sets - 1)) * this->associativity];
+
+    *victim = &set[0];
+    for (uint32_t way = 0; way < this->associativity; way++) {
+        if (set[way].tag == tag) {
+            return &set[way];
+        }
+        if (set[way].last_access < (*victim)->last_access) {
+            *victim = &set[way];
+        }
+    }
+    return NULL;
+};
+
+// =====================================================================
+void cache_t::fill_line(cache_line_t *victim, uint64_t address, uint64_t prefetch_stamp) {
+    if (victim->tag != CACHE_INVALID_TAG && victim->prefetch_stamp != 0) {
+        this->stat_prefetch_unused++;
+    }
+    victim->tag = address / this->line_size;
+    victim->last_access = this->access_stamp;
+    victim->prefetch_stamp = prefetch_stamp;
+};
+
+// =====================================================================
+/// Demand access. A hit on a prefetched line returns its prefetch stamp
+/// (0 otherwise), only on the first use.
+bool cache_t::access_prefetch(uint64_t address, uint64_t *prefetch_stamp) {
+    cache_line_t *victim;
+    cache_line_t *line = this->find_line(address, &victim);
+
+    this->access_stamp++;
+    this->stat_accesses++;
+    *prefetch_stamp = 0;
+    if (line != NULL) {
+        line->last_access = this->access_stamp;
+        *prefetch_stamp = line->prefetch_stamp;
+        line->prefetch_stamp = 0;
+        this->stat_hits++;
+        return true;
+    }
+
+    this->fill_line(victim, address, 0);
+    this->stat_misses++;
+    return false;
+};
+
+// =====================================================================
+/// Prefetch fill (as most recently used). Returns false if the line was
+/// already present.
+bool cache_t::prefetch(uint64_t address, uint64_t prefetch_stamp) {
+    cache_line_t *victim;
+    if (this->find_line(address, &victim) != NULL) {
+        return false;
+    }
+
+    this->access_stamp++;
+    this->fill_line(victim, address, prefetch_stamp);
+    return true;
+};
+
+// =====================================================================
+void cache_t::statistics(const char *name) {
+    ORCS_PRINTF("%s_accesses:%" PRIu64 "\n", name, this->stat_accesses);
+    ORCS_PRINTF("%s_hits:%" PRIu64 "\n", name, this->stat_hits);
+    ORCS_PRINTF("%s_misses:%" PRIu64 "\n", name, this->stat_misses);
+};
+
+// =====================================================================
+/// Contents and statistics; restoring needs the same geometry
+void cache_t::checkpoint(checkpoint_t *checkpoint) {
+    uint32_t sets = this->total_sets;
+    uint32_t ways = this->associativity;
+    uint32_t line_bytes = this->line_size;
+
+    checkpoint->section("CACH");
+    checkpoint->transfer(&sets);
+    checkpoint->transfer(&ways);
+    checkpoint->transfer(&line_bytes);
+    ERROR_ASSERT_PRINTF(this->has_geometry(sets, ways, line_bytes), "Checkpoint cache geometry %ux%ux%u differs from the configuration.\n", sets, ways, line_bytes);
+
+    checkpoint->transfer(this->lines, sizeof(cache_line_t) * sets * ways);
+    checkpoint->transfer(&this->access_stamp);
+    checkpoint->transfer(&this->stat_accesses);
+    checkpoint->transfer(&this->stat_hits);
+    checkpoint->transfer(&this->stat_misses);
+    checkpoint->transfer(&this->stat_prefetch_unused);
+};
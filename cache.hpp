@@ -0,0 +1,88 @@
+// ============================================================================
+// ============================================================================
+/// Set-associative cache with LRU replacement (tags only).
+/// The lookup is written once in access_geometry(). The generic access()
+/// passes the runtime geometry, while the specialized processor engines
+/// pass constants, so the compiler emits one unrolled copy for each.
+struct cache_line_t {
+    uint64_t tag;               /// Line address, CACHE_INVALID_TAG when empty
+    uint64_t last_access;       /// LRU stamp
+    uint64_t prefetch_stamp;    /// Prefetched and not used yet: issue stamp, otherwise 0
+};
+
+#define CACHE_INVALID_TAG UINT64_MAX
+
+// ============================================================================
+class cache_t {
+    private:
+        uint32_t total_sets;
+        uint32_t associativity;
+        uint32_t line_size;
+        cache_line_t *lines;        /// total_sets * associativity, set major
+        uint64_t access_stamp;
+
+        cache_line_t *find_line(uint64_t address, cache_line_t **victim);
+        void fill_line(cache_line_t *victim, uint64_t address, uint64_t prefetch_stamp);
+
+    public:
+        uint64_t stat_accesses;
+        uint64_t stat_hits;
+        uint64_t stat_misses;
+        uint64_t stat_prefetch_unused;  /// Prefetched lines evicted before any use
+
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        cache_t();
+        ~cache_t();
+        void allocate(uint32_t sets, uint32_t ways, uint32_t line_bytes);
+        bool has_geometry(uint32_t sets, uint32_t ways, uint32_t line_bytes);
+        void statistics(const char *name);
+        void checkpoint(checkpoint_t *checkpoint);
+
+        uint32_t get_total_sets() {
+            return this->total_sets;
+        };
+        uint32_t get_associativity() {
+            return this->associativity;
+        };
+        uint32_t get_line_size() {
+            return this->line_size;
+        };
+
+        /// Returns true on hit, a miss allocates the line.
+        /// The geometry must be the allocated one.
+        inline __attribute__((always_inline))
+        bool access_geometry(uint64_t address, uint32_t sets, uint32_t ways, uint32_t line_bytes) {
+            uint64_t tag = address / line_bytes;
+            cache_line_t *set = &this->lines[(tag & (sets - 1)) * ways];
+            cache_line_t *victim = &set[0];
+
+            this->access_stamp++;
+            this->stat_accesses++;
+            for (uint32_t way = 0; way < ways; way++) {
+                if (set[way].tag == tag) {
+                    set[way].last_access = this->access_stamp;
+                    this->stat_hits++;
+                    return true;
+                }
+                if (set[way].last_access < victim->last_access) {
+                    victim = &set[way];
+                }
+            }
+
+            victim->tag = tag;
+            victim->last_access = this->access_stamp;
+            victim->prefetch_stamp = 0;
+            this->stat_misses++;
+            return false;
+        };
+
+        bool access(uint64_t address) {
+            return this->access_geometry(address, this->total_sets, this->associativity, this->line_size);
+        };
+
+        /// Cache with prefetches (outside the processor hot path)
+        bool access_prefetch(uint64_t address, uint64_t *prefetch_stamp);
+        bool prefetch(uint64_t address, uint64_t prefetch_stamp);
+};
@@ -0,0 +1,50 @@
+#include "simulator.hpp"
+
+// =====================================================================
+checkpoint_t::checkpoint_t() {
+    this->file = NULL;
+    this->file_name[0] = '\0';
+    this->is_saving = false;
+};
+
+// =====================================================================
+checkpoint_t::~checkpoint_t() {
+    if (this->file != NULL) {
+        ERROR_ASSERT_PRINTF(fclose(this->file) == 0, "Could not close the checkpoint file.\n%s\n", this->file_name);
+    }
+};
+
+// =====================================================================
+void checkpoint_t::allocate(const char *checkpoint_file_name, bool saving) {
+    uint64_t magic = CHECKPOINT_MAGIC;
+    uint32_t version = CHECKPOINT_VERSION;
+
+    snprintf(this->file_name, sizeof(this->file_name), "%s", checkpoint_file_name);
+    this->is_saving = saving;
+    this->file = fopen(this->file_name, saving ? "wb" : "rb");
+    ERROR_ASSERT_PRINTF(this->file != NULL, "Could not open the checkpoint file.\n%s\n", this->file_name);
+
+    this->transfer(&magic);
+    this->transfer(&version);
+    ERROR_ASSERT_PRINTF(magic == CHECKPOINT_MAGIC, "Not an OrCS checkpoint.\n%s\n", this->file_name);
+    ERROR_ASSERT_PRINTF(version == CHECKPOINT_VERSION, "Checkpoint version %u, expected %u.\n%s\n", version, CHECKPOINT_VERSION, this->file_name);
+};
+
+// =====================================================================
+void checkpoint_t::section(const char *name) {
+    char tag[CHECKPOINT_SECTION_SIZE];
+    memcpy(tag, name, CHECKPOINT_SECTION_SIZE);
+
+    this->transfer(tag, CHECKPOINT_SECTION_SIZE);
+    ERROR_ASSERT_PRINTF(memcmp(tag, name, CHECKPOINT_SECTION_SIZE) == 0, "Checkpoint section %.4s found, expected %.4s.\n", tag, name);
+};
+
+// =====================================================================
+void checkpoint_t::transfer(void *data, uint64_t size) {
+    if (this->is_saving) {
+        ERROR_ASSERT_PRINTF(fwrite(data, 1, size, this->file) == size, "Could not write the checkpoint file.\n%s\n", this->file_name);
+    }
+    else {
+        ERROR_ASSERT_PRINTF(fread(data, 1, size, this->file) == size, "Checkpoint file truncated.\n%s\n", this->file_name);
+    }
+};
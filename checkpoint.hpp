@@ -0,0 +1,38 @@
+// ============================================================================
+// ============================================================================
+/// Binary checkpoint of the complete simulator state.
+/// The same checkpoint() method of each component saves or restores its
+/// state, so both directions always agree on the layout.
+/// Any change in a component layout must increase CHECKPOINT_VERSION.
+#define CHECKPOINT_MAGIC 0x544e504b43534352ULL     /// "RCSCKPNT"
+#define CHECKPOINT_VERSION 5
+#define CHECKPOINT_SECTION_SIZE 4
+
+class checkpoint_t {
+    private:
+        FILE *file;
+        char file_name[TRACE_LINE_SIZE];
+        bool is_saving;
+
+    public:
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        checkpoint_t();
+        ~checkpoint_t();
+        void allocate(const char *checkpoint_file_name, bool saving);
+
+        bool is_restoring() {
+            return !this->is_saving;
+        };
+
+        /// Save a section tag or check it on restore
+        void section(const char *name);
+        /// Save or restore raw bytes
+        void transfer(void *data, uint64_t size);
+
+        template <class TYPE>
+        void transfer(TYPE *data) {
+            this->transfer((void*)data, sizeof(TYPE));
+        };
+};
@@ -0,0 +1,200 @@
+#include "simulator.hpp"
+
+// =====================================================================
+static const char *config_operation_name[INSTRUCTION_OPERATION_TOTAL] = {
+    "latency.nop",
+    "latency.int_alu",
+    "latency.int_mul",
+    "latency.int_div",
+    "latency.fp_alu",
+    "latency.fp_mul",
+    "latency.fp_div",
+    "latency.branch",
+    "latency.mem_load",
+    "latency.mem_store",
+    "latency.other",
+    "latency.barrier",
+    "latency.hmc_roa",
+    "latency.hmc_rowa"
+};
+
+static const uint32_t config_operation_latency[INSTRUCTION_OPERATION_TOTAL] = {
+    1,      /// NOP
+    1,      /// INT_ALU
+    3,      /// INT_MUL
+    20,     /// INT_DIV
+    3,      /// FP_ALU
+    5,      /// FP_MUL
+    20,     /// FP_DIV
+    1,      /// BRANCH
+    1,      /// MEM_LOAD (address generation, the cache latency is added)
+    1,      /// MEM_STORE
+    1,      /// OTHER
+    1,      /// BARRIER
+    1,      /// HMC_ROA
+    1       /// HMC_ROWA
+};
+
+// =====================================================================
+static char *config_trim(char *input_string) {
+    while (*input_string == ' ' || *input_string == '\t') {
+        input_string++;
+    }
+    char *end = input_string + strlen(input_string);
+    while (end > input_string && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) {
+        end--;
+    }
+    *end = '\0';
+    return input_string;
+};
+
+// =====================================================================
+config_t::config_t() {
+    this->total_parameters = 0;
+    snprintf(this->file_name, sizeof(this->file_name), "(defaults)");
+
+    /// Name, Variable, Default, Min, Max, Power of Two
+    this->add_parameter("processor.fetch_width", &this->fetch_width, 4, 1, 16, false);
+    for (uint32_t i = 0; i < INSTRUCTION_OPERATION_TOTAL; i++) {
+        this->add_parameter(config_operation_name[i], &this->latency[i], config_operation_latency[i], 1, 1000, false);
+    }
+
+    /// Any size with a power-of-two number of sets (checked in validate)
+    this->add_parameter("l1d.size", &this->l1d_size, 32768, 1024, 1 << 30, false);
+    this->add_parameter("l1d.associativity", &this->l1d_associativity, 8, 1, 32, false);
+    this->add_parameter("l1d.line_size", &this->l1d_line_size, 64, 16, 4096, true);
+    this->add_parameter("l1d.hit_latency", &this->l1d_hit_latency, 3, 1, 1000, false);
+
+    this->add_parameter("memory.channels", &this->memory_channels, 2, 1, 64, true);
+    this->add_parameter("memory.ranks", &this->memory_ranks, 2, 1, 16, true);
+    this->add_parameter("memory.banks", &this->memory_banks, 8, 1, 64, true);
+    this->add_parameter("memory.row_size", &this->memory_row_size, 8192, 64, 1 << 20, true);
+    this->add_parameter("memory.line_size", &this->memory_line_size, 64, 16, 4096, true);
+    this->add_parameter("memory.row_policy", &this->memory_row_policy, MEMORY_ROW_POLICY_OPEN, MEMORY_ROW_POLICY_OPEN, MEMORY_ROW_POLICY_CLOSED, false);
+    this->add_parameter("memory.controller_latency", &this->memory_controller_latency, 10, 0, 10000, false);
+    this->add_parameter("memory.t_cas", &this->memory_t_cas, 44, 1, 10000, false);
+    this->add_parameter("memory.t_rcd", &this->memory_t_rcd, 44, 1, 10000, false);
+    this->add_parameter("memory.t_rp", &this->memory_t_rp, 44, 1, 10000, false);
+    this->add_parameter("memory.t_ras", &this->memory_t_ras, 112, 1, 10000, false);
+    this->add_parameter("memory.t_burst", &this->memory_t_burst, 16, 1, 10000, false);
+    this->add_parameter("memory.request_pool", &this->memory_request_pool, 64, 1, 65536, false);
+
+    this->add_parameter("hmc.vaults", &this->hmc_vaults, 32, 1, 256, true);
+    this->add_parameter("hmc.banks", &this->hmc_banks, 8, 1, 64, true);
+    this->add_parameter("hmc.row_size", &this->hmc_row_size, 256, 64, 1 << 20, true);
+    this->add_parameter("hmc.link_latency", &this->hmc_link_latency, 20, 0, 10000, false);
+    this->add_parameter("hmc.op_latency", &this->hmc_op_latency, 4, 0, 10000, false);
+
+    this->add_parameter("allocator.huge_pages", &this->allocator_huge_pages, HUGE_PAGE_NONE, HUGE_PAGE_NONE, HUGE_PAGE_EXPLICIT, false);
+    this->add_parameter("broadcast.ring_batches", &this->broadcast_ring_batches, 64, 2, 65536, false);
+
+    this->add_parameter("prefetcher.degree", &this->prefetcher_degree, 4, 1, PREFETCH_MAX_DEGREE, false);
+    this->add_parameter("prefetcher.table_size", &this->prefetcher_table_size, 256, 16, 1 << 20, true);
+    this->add_parameter("prefetcher.streams", &this->prefetcher_streams, 16, 1, 256, false);
+    this->add_parameter("prefetcher.ghb_size", &this->prefetcher_ghb_size, 512, 16, 1 << 20, false);
+};
+
+// =====================================================================
+void config_t::add_parameter(const char *name, uint32_t *value, uint32_t default_value,
+                                uint32_t min, uint32_t max, bool is_power_of_two) {
+    ERROR_ASSERT_PRINTF(this->total_parameters < CONFIG_MAX_PARAMETERS, "Too many configuration parameters.\n");
+
+    this->parameter[this->total_parameters].name = name;
+    this->parameter[this->total_parameters].value = value;
+    this->parameter[this->total_parameters].min = min;
+    this->parameter[this->total_parameters].max = max;
+    this->parameter[this->total_parameters].is_power_of_two = is_power_of_two;
+    this->total_parameters++;
+
+    *value = default_value;
+};
+
+// =====================================================================
+void config_t::set_parameter(const char *name, const char *value, uint32_t line) {
+    for (uint32_t i = 0; i < this->total_parameters; i++) {
+        if (strcmp(this->parameter[i].name, name) == 0) {
+            char *end = NULL;
+            uint64_t number = strtoull(value, &end, 0);
+            ERROR_ASSERT_PRINTF(value[0] != '\0' && *end == '\0' && number <= UINT32_MAX,
+                                "Configuration %s:%u: invalid value \"%s\" for %s.\n", this->file_name, line, value, name);
+            *this->parameter[i].value = (uint32_t)number;
+            return;
+        }
+    }
+    ERROR_PRINTF("Configuration %s:%u: unknown parameter \"%s\".\n", this->file_name, line, name);
+};
+
+// =====================================================================
+void config_t::validate() {
+    for (uint32_t i = 0; i < this->total_parameters; i++) {
+        uint32_t value = *this->parameter[i].value;
+        ERROR_ASSERT_PRINTF(value >= this->parameter[i].min && value <= this->parameter[i].max,
+                            "Configuration %s: %s = %u out of range [%u, %u].\n", this->file_name,
+                            this->parameter[i].name, value, this->parameter[i].min, this->parameter[i].max);
+        ERROR_ASSERT_PRINTF(!this->parameter[i].is_power_of_two || (value & (value - 1)) == 0,
+                            "Configuration %s: %s = %u must be a power of two.\n", this->file_name,
+                            this->parameter[i].name, value);
+    }
+
+    /// Cache geometry
+    ERROR_ASSERT_PRINTF(this->l1d_size % (this->l1d_associativity * this->l1d_line_size) == 0,
+                        "Configuration %s: l1d.size must be a multiple of l1d.associativity * l1d.line_size.\n", this->file_name);
+    uint32_t l1d_sets = this->get_l1d_sets();
+    ERROR_ASSERT_PRINTF(l1d_sets > 0 && (l1d_sets & (l1d_sets - 1)) == 0,
+                        "Configuration %s: l1d sets (%u) must be a power of two.\n", this->file_name, l1d_sets);
+
+    /// Memory geometry
+    ERROR_ASSERT_PRINTF(this->memory_row_size >= this->memory_line_size && this->hmc_row_size >= this->memory_line_size,
+                        "Configuration %s: memory.row_size and hmc.row_size must hold at least one memory.line_size.\n", this->file_name);
+};
+
+// =====================================================================
+/// Without a file name the defaults are used
+void config_t::allocate(const char *config_file_name) {
+    if (config_file_name != NULL) {
+        snprintf(this->file_name, sizeof(this->file_name), "%s", config_file_name);
+
+        FILE *config_file = fopen(config_file_name, "r");
+        ERROR_ASSERT_PRINTF(config_file != NULL, "Could not open the configuration file.\n%s\n", config_file_name);
+
+        char file_line[TRACE_LINE_SIZE];
+        uint32_t line = 0;
+        while (fgets(file_line, sizeof(file_line), config_file) != NULL) {
+            line++;
+
+            char *comment = strchr(file_line, '#');
+            if (comment != NULL) {
+                *comment = '\0';
+            }
+            char *name = config_trim(file_line);
+            if (name[0] == '\0') {
+                continue;
+            }
+
+            char *value = strchr(name, '=');
+            ERROR_ASSERT_PRINTF(value != NULL, "Configuration %s:%u: expected \"key = value\".\n", this->file_name, line);
+            *value = '\0';
+            this->set_parameter(config_trim(name), config_trim(value + 1), line);
+        }
+        fclose(config_file);
+    }
+
+    this->validate();
+};
+
+// =====================================================================
+/// Change one parameter after allocate(), e.g. a prefetcher variant in -e
+void config_t::override_parameter(const char *name, const char *value) {
+    this->set_parameter(name, value, 0);
+    this->validate();
+};
+
+// =====================================================================
+void config_t::statistics() {
+    ORCS_PRINTF("######################################################\n");
+    ORCS_PRINTF("config_t\n");
+    ORCS_PRINTF("file_name:%s\n", this->file_name);
+    for (uint32_t i = 0; i < this->total_parameters; i++) {
+        ORCS_PRINTF("%s:%u\n", this->parameter[i].name, *this->parameter[i].value);
+    }
+};
@@ -0,0 +1,99 @@
+// ============================================================================
+// ============================================================================
+/// Microarchitecture parameters.
+/// Read from a "key = value" file (one per line, '#' starts a comment),
+/// every key not present keeps its default value. Unknown keys and
+/// values out of range stop the simulation at startup.
+///
+/// Config File Example:
+///
+/// # Narrow core
+/// processor.fetch_width = 2
+/// latency.int_div = 20
+/// l1d.size = 32768
+/// l1d.associativity = 8
+/// memory.row_policy = 1       # closed
+///
+#define CONFIG_MAX_PARAMETERS 64
+
+#define INSTRUCTION_OPERATION_TOTAL (INSTRUCTION_OPERATION_HMC_ROWA + 1)
+
+// ============================================================================
+struct config_parameter_t {
+    const char *name;
+    uint32_t *value;
+    uint32_t min;
+    uint32_t max;
+    bool is_power_of_two;
+};
+
+// ============================================================================
+class config_t {
+    private:
+        config_parameter_t parameter[CONFIG_MAX_PARAMETERS];
+        uint32_t total_parameters;
+
+        void add_parameter(const char *name, uint32_t *value, uint32_t default_value,
+                            uint32_t min, uint32_t max, bool is_power_of_two);
+        void set_parameter(const char *name, const char *value, uint32_t line);
+        void validate();
+
+    public:
+        char file_name[TRACE_LINE_SIZE];
+
+        /// Processor
+        uint32_t fetch_width;
+        uint32_t latency[INSTRUCTION_OPERATION_TOTAL];  /// Execution latency by operation
+
+        /// L1 Data Cache
+        uint32_t l1d_size;
+        uint32_t l1d_associativity;
+        uint32_t l1d_line_size;
+        uint32_t l1d_hit_latency;
+
+        /// Main Memory (DRAM), timings in processor cycles
+        uint32_t memory_channels;
+        uint32_t memory_ranks;
+        uint32_t memory_banks;
+        uint32_t memory_row_size;
+        uint32_t memory_line_size;
+        uint32_t memory_row_policy;     /// memory_row_policy_t
+        uint32_t memory_controller_latency;
+        uint32_t memory_t_cas;
+        uint32_t memory_t_rcd;
+        uint32_t memory_t_rp;
+        uint32_t memory_t_ras;
+        uint32_t memory_t_burst;
+        uint32_t memory_request_pool;
+
+        /// HMC cube for the near-memory operations
+        uint32_t hmc_vaults;
+        uint32_t hmc_banks;
+        uint32_t hmc_row_size;
+        uint32_t hmc_link_latency;
+        uint32_t hmc_op_latency;
+
+        /// Backing of the arenas and pools (huge_page_mode_t)
+        uint32_t allocator_huge_pages;
+
+        /// Batches the broadcast decoder may run ahead of the slowest child
+        uint32_t broadcast_ring_batches;
+
+        /// Prefetchers (evaluation mode)
+        uint32_t prefetcher_degree;
+        uint32_t prefetcher_table_size; /// Per-PC table entries
+        uint32_t prefetcher_streams;
+        uint32_t prefetcher_ghb_size;
+
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        config_t();
+        void allocate(const char *config_file_name);
+        void override_parameter(const char *name, const char *value);
+        void statistics();
+
+        uint32_t get_l1d_sets() {
+            return this->l1d_size / (this->l1d_associativity * this->l1d_line_size);
+        };
+};
@@ -0,0 +1,352 @@
+#include "simulator.hpp"
+
+// =====================================================================
+static uint32_t memory_log2(uint32_t value) {
+    return __builtin_ctz(value);
+};
+
+// =====================================================================
+memory_controller_t::memory_controller_t() {
+    this->channel = NULL;
+    this->vault = NULL;
+    this->event_queue = NULL;
+    this->pool_size = 0;
+    this->event_queue_size = 0;
+
+    for (uint32_t i = 0; i < MEMORY_OPERATION_TOTAL; i++) {
+        this->stat_requests[i] = 0;
+        this->stat_latency[i] = 0;
+    }
+    this->stat_row_hits = 0;
+    this->stat_row_empty = 0;
+    this->stat_row_conflicts = 0;
+    this->stat_pool_full = 0;
+};
+
+// =====================================================================
+memory_controller_t::~memory_controller_t() {
+    this->release_all();
+};
+
+// =====================================================================
+void memory_controller_t::release_all() {
+    if (this->channel != NULL) {
+        for (uint32_t c = 0; c < this->total_channels; c++) {
+            for (uint32_t r = 0; r < this->total_ranks; r++) {
+                delete[] this->channel[c].rank[r].bank;
+            }
+            delete[] this->channel[c].rank;
+        }
+        delete[] this->channel;
+    }
+    if (this->vault != NULL) {
+        for (uint32_t v = 0; v < this->total_vaults; v++) {
+            delete[] this->vault[v].bank;
+        }
+        delete[] this->vault;
+    }
+    this->request_pool.release_all();
+    delete[] this->event_queue;
+
+    this->channel = NULL;
+    this->vault = NULL;
+    this->event_queue = NULL;
+};
+
+// =====================================================================
+/// Also called by a forked child after loading its own configuration,
+/// the memory restarts empty (rows closed, no request in flight)
+void memory_controller_t::allocate() {
+    config_t *config = orcs_engine.config;
+
+    this->release_all();
+
+    this->total_channels = config->memory_channels;
+    this->total_ranks = config->memory_ranks;
+    this->total_banks = config->memory_banks;
+    this->total_vaults = config->hmc_vaults;
+    this->total_vault_banks = config->hmc_banks;
+    this->line_size = config->memory_line_size;
+    this->lines_per_row = config->memory_row_size / config->memory_line_size;
+    this->lines_per_vault_row = config->hmc_row_size / config->memory_line_size;
+    this->row_policy = memory_row_policy_t(config->memory_row_policy);
+    this->controller_latency = config->memory_controller_latency;
+    this->t_cas = config->memory_t_cas;
+    this->t_rcd = config->memory_t_rcd;
+    this->t_rp = config->memory_t_rp;
+    this->t_ras = config->memory_t_ras;
+    this->t_burst = config->memory_t_burst;
+    this->hmc_link_latency = config->hmc_link_latency;
+    this->hmc_op_latency = config->hmc_op_latency;
+
+    /// DRAM: channels -> ranks -> banks
+    this->channel = new memory_channel_t[this->total_channels];
+    ERROR_ASSERT_PRINTF(this->channel != NULL, "Could not allocate memory\n");
+    for (uint32_t c = 0; c < this->total_channels; c++) {
+        this->channel[c].bus_ready_cycle = 0;
+        this->channel[c].rank = new memory_rank_t[this->total_ranks];
+        ERROR_ASSERT_PRINTF(this->channel[c].rank != NULL, "Could not allocate memory\n");
+        for (uint32_t r = 0; r < this->total_ranks; r++) {
+            this->channel[c].rank[r].bank = new memory_bank_t[this->total_banks];
+            ERROR_ASSERT_PRINTF(this->channel[c].rank[r].bank != NULL, "Could not allocate memory\n");
+            memset(this->channel[c].rank[r].bank, 0, sizeof(memory_bank_t) * this->total_banks);
+        }
+    }
+
+    /// HMC: vaults -> banks
+    this->vault = new memory_vault_t[this->total_vaults];
+    ERROR_ASSERT_PRINTF(this->vault != NULL, "Could not allocate memory\n");
+    for (uint32_t v = 0; v < this->total_vaults; v++) {
+        this->vault[v].logic_ready_cycle = 0;
+        this->vault[v].bank = new memory_bank_t[this->total_vault_banks];
+        ERROR_ASSERT_PRINTF(this->vault[v].bank != NULL, "Could not allocate memory\n");
+        memset(this->vault[v].bank, 0, sizeof(memory_bank_t) * this->total_vault_banks);
+    }
+
+    /// Request pool, all free
+    this->pool_size = config->memory_request_pool;
+    this->request_pool.allocate(this->pool_size, ALLOCATION_MEMORY_REQUESTS);
+    this->event_queue = new uint32_t[this->pool_size];
+    ERROR_ASSERT_PRINTF(this->event_queue != NULL, "Could not allocate memory\n");
+    this->event_queue_size = 0;
+};
+
+// =====================================================================
+/// Book one access on the bank calendar, returns the cycle the data is
+/// ready at the bank
+uint64_t memory_controller_t::bank_access(memory_bank_t *bank, uint64_t row, uint64_t cycle, bool close_row) {
+    uint64_t start = (cycle > bank->ready_cycle) ? cycle : bank->ready_cycle;
+    uint64_t data_ready;
+
+    if (bank->is_row_open && bank->open_row == row) {
+        this->stat_row_hits++;
+        data_ready = start + this->t_cas;
+    }
+    else if (bank->is_row_open) {
+        this->stat_row_conflicts++;
+        uint64_t precharge = bank->activate_cycle + this->t_ras;
+        if (precharge < start) {
+            precharge = start;
+        }
+        bank->activate_cycle = precharge + this->t_rp;
+        data_ready = bank->activate_cycle + this->t_rcd + this->t_cas;
+    }
+    else {
+        this->stat_row_empty++;
+        bank->activate_cycle = start;
+        data_ready = start + this->t_rcd + this->t_cas;
+    }
+
+    if (close_row) {
+        /// Auto-precharge after the access, respecting tRAS
+        uint64_t precharge = bank->activate_cycle + this->t_ras;
+        if (precharge < data_ready) {
+            precharge = data_ready;
+        }
+        bank->is_row_open = false;
+        bank->ready_cycle = precharge + this->t_rp;
+    }
+    else {
+        /// The next column command may follow one burst later
+        bank->is_row_open = true;
+        bank->open_row = row;
+        bank->ready_cycle = data_ready - this->t_cas + this->t_burst;
+    }
+    return data_ready;
+};
+
+// =====================================================================
+/// Address: | row | rank | bank | column | channel | line offset |
+uint64_t memory_controller_t::dram_access(uint64_t address, uint64_t cycle) {
+    uint64_t line = address >> memory_log2(this->line_size);
+    uint32_t channel_id = line & (this->total_channels - 1);
+    line >>= memory_log2(this->total_channels);
+    line >>= memory_log2(this->lines_per_row);          /// Column
+    uint32_t bank_id = line & (this->total_banks - 1);
+    line >>= memory_log2(this->total_banks);
+    uint32_t rank_id = line & (this->total_ranks - 1);
+    uint64_t row = line >> memory_log2(this->total_ranks);
+
+    memory_channel_t *memory_channel = &this->channel[channel_id];
+    memory_bank_t *bank = &memory_channel->rank[rank_id].bank[bank_id];
+    uint64_t data_ready = this->bank_access(bank, row, cycle + this->controller_latency,
+                                            this->row_policy == MEMORY_ROW_POLICY_CLOSED);
+
+    /// Data bus transfer
+    uint64_t transfer = (data_ready > memory_channel->bus_ready_cycle) ? data_ready : memory_channel->bus_ready_cycle;
+    memory_channel->bus_ready_cycle = transfer + this->t_burst;
+    return transfer + this->t_burst;
+};
+
+// =====================================================================
+/// Address: | row | bank | column | vault | line offset |
+/// Request packet over the link, closed-page access in the vault, the
+/// operation in the vault logic (ROWA also writes the result back) and
+/// the answer packet over the link.
+uint64_t memory_controller_t::hmc_access(uint64_t address, memory_operation_t operation, uint64_t cycle) {
+    uint64_t line = address >> memory_log2(this->line_size);
+    uint32_t vault_id = line & (this->total_vaults - 1);
+    line >>= memory_log2(this->total_vaults);
+    line >>= memory_log2(this->lines_per_vault_row);    /// Column
+    uint32_t bank_id = line & (this->total_vault_banks - 1);
+    uint64_t row = line >> memory_log2(this->total_vault_banks);
+
+    memory_vault_t *memory_vault = &this->vault[vault_id];
+    memory_bank_t *bank = &memory_vault->bank[bank_id];
+    uint64_t data_ready = this->bank_access(bank, row, cycle + this->hmc_link_latency, true);
+
+    uint64_t operation_start = (data_ready > memory_vault->logic_ready_cycle) ? data_ready : memory_vault->logic_ready_cycle;
+    uint64_t operation_done = operation_start + this->hmc_op_latency;
+    memory_vault->logic_ready_cycle = operation_done;
+
+    if (operation == MEMORY_OPERATION_HMC_ROWA) {
+        /// Write-back of the result keeps the bank busy
+        uint64_t write_done = operation_done + this->t_rcd + this->t_burst + this->t_rp;
+        if (bank->ready_cycle < write_done) {
+            bank->ready_cycle = write_done;
+        }
+    }
+    return operation_done + this->hmc_link_latency;
+};
+
+// =====================================================================
+uint64_t memory_controller_t::request(uint64_t address, memory_operation_t operation, uint64_t cycle) {
+    /// Pool full: the request waits for the oldest one to finish
+    if (this->request_pool.is_empty()) {
+        this->stat_pool_full++;
+        uint64_t free_cycle = this->request_pool[this->event_queue[0]].ready_cycle;
+        if (cycle < free_cycle) {
+            cycle = free_cycle;
+        }
+        this->retire();
+    }
+
+    uint64_t ready_cycle;
+    if (operation == MEMORY_OPERATION_HMC_ROA || operation == MEMORY_OPERATION_HMC_ROWA) {
+        ready_cycle = this->hmc_access(address, operation, cycle);
+    }
+    else {
+        ready_cycle = this->dram_access(address, cycle);
+    }
+
+    uint32_t slot = this->request_pool.acquire();
+    this->request_pool[slot].address = address;
+    this->request_pool[slot].operation = operation;
+    this->request_pool[slot].issue_cycle = cycle;
+    this->request_pool[slot].ready_cycle = ready_cycle;
+    this->event_push(slot);
+
+    return ready_cycle;
+};
+
+// =====================================================================
+void memory_controller_t::event_push(uint32_t request) {
+    uint32_t position = this->event_queue_size++;
+    uint64_t ready_cycle = this->request_pool[request].ready_cycle;
+
+    while (position > 0) {
+        uint32_t parent = (position - 1) / 2;
+        if (this->request_pool[this->event_queue[parent]].ready_cycle <= ready_cycle) {
+            break;
+        }
+        this->event_queue[position] = this->event_queue[parent];
+        position = parent;
+    }
+    this->event_queue[position] = request;
+};
+
+// =====================================================================
+/// Pop every request ready by now (or by the ready_cycle of the head)
+void memory_controller_t::retire() {
+    uint64_t now = orcs_engine.get_global_cycle();
+    if (this->event_queue_size > 0 && this->request_pool[this->event_queue[0]].ready_cycle > now) {
+        now = this->request_pool[this->event_queue[0]].ready_cycle;
+    }
+
+    while (this->event_queue_size > 0 && this->request_pool[this->event_queue[0]].ready_cycle <= now) {
+        uint32_t head = this->event_queue[0];
+        memory_request_t *request = &this->request_pool[head];
+        this->stat_requests[request->operation]++;
+        if (request->ready_cycle > request->issue_cycle) {
+            this->stat_latency[request->operation] += request->ready_cycle - request->issue_cycle;
+        }
+
+        /// Sift down the last element
+        uint32_t last = this->event_queue[--this->event_queue_size];
+        uint64_t last_ready = this->request_pool[last].ready_cycle;
+        uint32_t position = 0;
+        for (;;) {
+            uint32_t child = position * 2 + 1;
+            if (child >= this->event_queue_size) {
+                break;
+            }
+            if (child + 1 < this->event_queue_size &&
+                this->request_pool[this->event_queue[child + 1]].ready_cycle < this->request_pool[this->event_queue[child]].ready_cycle) {
+                child++;
+            }
+            if (this->request_pool[this->event_queue[child]].ready_cycle >= last_ready) {
+                break;
+            }
+            this->event_queue[position] = this->event_queue[child];
+            position = child;
+        }
+        if (this->event_queue_size > 0) {
+            this->event_queue[position] = last;
+        }
+
+        this->request_pool.release(head);
+    }
+};
+
+// =====================================================================
+void memory_controller_t::statistics() {
+    const char *operation_name[MEMORY_OPERATION_TOTAL] = {"read", "write", "hmc_roa", "hmc_rowa"};
+
+    ORCS_PRINTF("######################################################\n");
+    ORCS_PRINTF("memory_controller_t\n");
+    for (uint32_t i = 0; i < MEMORY_OPERATION_TOTAL; i++) {
+        ORCS_PRINTF("%s_requests:%" PRIu64 "\n", operation_name[i], this->stat_requests[i]);
+        ORCS_PRINTF("%s_avg_latency:%.2f\n", operation_name[i],
+                        this->stat_requests[i] ? (double)this->stat_latency[i] / this->stat_requests[i] : 0.0);
+    }
+    ORCS_PRINTF("row_hits:%" PRIu64 "\n", this->stat_row_hits);
+    ORCS_PRINTF("row_empty:%" PRIu64 "\n", this->stat_row_empty);
+    ORCS_PRINTF("row_conflicts:%" PRIu64 "\n", this->stat_row_conflicts);
+    ORCS_PRINTF("pool_full:%" PRIu64 "\n", this->stat_pool_full);
+};
+
+// =====================================================================
+/// Calendars, requests in flight and statistics; the configuration must
+/// have the same geometry
+void memory_controller_t::checkpoint(checkpoint_t *checkpoint) {
+    uint32_t geometry[6] = {this->total_channels, this->total_ranks, this->total_banks,
+                            this->total_vaults, this->total_vault_banks, this->pool_size};
+    uint32_t saved_geometry[6];
+    memcpy(saved_geometry, geometry, sizeof(geometry));
+
+    checkpoint->section("MEMC");
+    checkpoint->transfer(saved_geometry, sizeof(saved_geometry));
+    ERROR_ASSERT_PRINTF(memcmp(saved_geometry, geometry, sizeof(geometry)) == 0, "Checkpoint memory geometry differs from the configuration.\n");
+
+    for (uint32_t c = 0; c < this->total_channels; c++) {
+        checkpoint->transfer(&this->channel[c].bus_ready_cycle);
+        for (uint32_t r = 0; r < this->total_ranks; r++) {
+            checkpoint->transfer(this->channel[c].rank[r].bank, sizeof(memory_bank_t) * this->total_banks);
+        }
+    }
+    for (uint32_t v = 0; v < this->total_vaults; v++) {
+        checkpoint->transfer(&this->vault[v].logic_ready_cycle);
+        checkpoint->transfer(this->vault[v].bank, sizeof(memory_bank_t) * this->total_vault_banks);
+    }
+
+    this->request_pool.checkpoint(checkpoint);
+    checkpoint->transfer(this->event_queue, sizeof(uint32_t) * this->pool_size);
+    checkpoint->transfer(&this->event_queue_size);
+
+    checkpoint->transfer(this->stat_requests, sizeof(this->stat_requests));
+    checkpoint->transfer(this->stat_latency, sizeof(this->stat_latency));
+    checkpoint->transfer(&this->stat_row_hits);
+    checkpoint->transfer(&this->stat_row_empty);
+    checkpoint->transfer(&this->stat_row_conflicts);
+    checkpoint->transfer(&this->stat_pool_full);
+};
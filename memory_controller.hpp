@@ -0,0 +1,125 @@
+// ============================================================================
+// ============================================================================
+/// Main memory: DRAM (channels / ranks / banks) for ordinary loads and
+/// stores and an HMC cube (vaults / banks) for the near-memory operations
+/// INSTRUCTION_OPERATION_HMC_ROA and INSTRUCTION_OPERATION_HMC_ROWA.
+///
+/// Nothing is polled per cycle. Each bank keeps a timing calendar (when it
+/// is free, which row is open, when it was activated) and each channel
+/// keeps when its data bus is free, so request() computes the completion
+/// cycle as soon as a request arrives. In-flight requests live in a
+/// fixed-size pool (pool_t), ordered by completion cycle in an event queue (binary
+/// heap); clock() only looks at the head of the queue.
+/// All the timings are in processor cycles.
+
+// ============================================================================
+enum memory_operation_t {
+    MEMORY_OPERATION_READ,
+    MEMORY_OPERATION_WRITE,
+    MEMORY_OPERATION_HMC_ROA,      /// READ+OP +Answer
+    MEMORY_OPERATION_HMC_ROWA,     /// READ+OP+WRITE +Answer
+    MEMORY_OPERATION_TOTAL
+};
+
+// ============================================================================
+/// Row-buffer policies (memory.row_policy)
+enum memory_row_policy_t {
+    MEMORY_ROW_POLICY_OPEN,
+    MEMORY_ROW_POLICY_CLOSED
+};
+
+// ============================================================================
+struct memory_bank_t {
+    uint64_t ready_cycle;           /// Next cycle a command may start
+    uint64_t activate_cycle;        /// Last ACTIVATE (for tRAS)
+    uint64_t open_row;
+    bool is_row_open;
+};
+
+struct memory_rank_t {
+    memory_bank_t *bank;
+};
+
+struct memory_channel_t {
+    memory_rank_t *rank;
+    uint64_t bus_ready_cycle;       /// Next cycle the data bus is free
+};
+
+struct memory_vault_t {
+    memory_bank_t *bank;
+    uint64_t logic_ready_cycle;     /// Next cycle the vault logic is free
+};
+
+struct memory_request_t {
+    uint64_t address;
+    memory_operation_t operation;
+    uint64_t issue_cycle;
+    uint64_t ready_cycle;
+};
+
+// ============================================================================
+class memory_controller_t {
+    private:
+        /// Parameters copied from the configuration
+        uint32_t total_channels;
+        uint32_t total_ranks;
+        uint32_t total_banks;
+        uint32_t total_vaults;
+        uint32_t total_vault_banks;
+        uint32_t line_size;
+        uint32_t lines_per_row;
+        uint32_t lines_per_vault_row;
+        memory_row_policy_t row_policy;
+        uint32_t controller_latency;
+        uint32_t t_cas;
+        uint32_t t_rcd;
+        uint32_t t_rp;
+        uint32_t t_ras;
+        uint32_t t_burst;
+        uint32_t hmc_link_latency;
+        uint32_t hmc_op_latency;
+
+        memory_channel_t *channel;
+        memory_vault_t *vault;
+
+        /// Fixed-size request pool and event queue
+        uint32_t pool_size;
+        pool_t<memory_request_t> request_pool;
+        uint32_t *event_queue;          /// Heap of pool indexes by ready_cycle
+        uint32_t event_queue_size;
+
+        void release_all();
+        uint64_t bank_access(memory_bank_t *bank, uint64_t row, uint64_t cycle, bool close_row);
+        uint64_t dram_access(uint64_t address, uint64_t cycle);
+        uint64_t hmc_access(uint64_t address, memory_operation_t operation, uint64_t cycle);
+        void event_push(uint32_t request);
+        void retire();
+
+    public:
+        /// Statistics
+        uint64_t stat_requests[MEMORY_OPERATION_TOTAL];
+        uint64_t stat_latency[MEMORY_OPERATION_TOTAL];
+        uint64_t stat_row_hits;
+        uint64_t stat_row_empty;
+        uint64_t stat_row_conflicts;
+        uint64_t stat_pool_full;
+
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        memory_controller_t();
+        ~memory_controller_t();
+        void allocate();
+        void statistics();
+        void checkpoint(checkpoint_t *checkpoint);
+
+        /// Returns the cycle the answer is ready
+        uint64_t request(uint64_t address, memory_operation_t operation, uint64_t cycle);
+
+        void clock() {
+            if (this->event_queue_size > 0 &&
+                this->request_pool[this->event_queue[0]].ready_cycle <= orcs_engine.get_global_cycle()) {
+                this->retire();
+            }
+        };
+};
@@ -4,7 +4,7 @@
 opcode_package_t::opcode_package_t() {
 
     /// TRACE Variables
-    sprintf(this->opcode_assembly, "N/A");
+    this->opcode_assembly = "N/A";
     this->opcode_operation = INSTRUCTION_OPERATION_NOP;
     this->opcode_address = 0;
     this->opcode_size = 0;
@@ -3,7 +3,7 @@
 class opcode_package_t {
     public:
         /// TRACE Variables
-        char opcode_assembly[TRACE_LINE_SIZE];
+        const char *opcode_assembly;    /// Interned in the trace reader string table
         instruction_operation_t opcode_operation;
         uint64_t opcode_address;
         uint32_t opcode_size;
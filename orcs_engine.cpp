@@ -7,7 +7,113 @@ orcs_engine_t::orcs_engine_t() {
 
 // =====================================================================
 void orcs_engine_t::allocate() {
+	this->config = new config_t;
+	this->config->allocate(this->arg_config_file_name);
+	this->allocator = new allocator_t;
+	this->allocator->allocate();
 	this->trace_reader = new trace_reader_t;
 	this->processor = new processor_t;
+	this->memory = new memory_controller_t;
+	this->stats_page = new stats_page_t;
 };
 
+
+// =====================================================================
+/// Load a new configuration (from the defaults) and apply it on the
+/// components already allocated, keeping their state when compatible
+void orcs_engine_t::configure(const char *config_file_name) {
+	delete this->config;
+	this->config = new config_t;
+	this->config->allocate(config_file_name);
+
+	this->allocator->allocate();
+	this->processor->allocate();
+	this->memory->allocate();
+};
+
+// =====================================================================
+void orcs_engine_t::checkpoint(checkpoint_t *checkpoint) {
+	checkpoint->section("ENGN");
+	checkpoint->transfer(&this->global_cycle);
+
+	this->trace_reader->checkpoint(checkpoint);
+	this->processor->checkpoint(checkpoint);
+	this->memory->checkpoint(checkpoint);
+};
+
+// =====================================================================
+void orcs_engine_t::checkpoint_save(const char *file_name) {
+	checkpoint_t checkpoint;
+	checkpoint.allocate(file_name, true);
+	this->checkpoint(&checkpoint);
+	ORCS_PRINTF("Checkpoint saved at cycle %" PRIu64 ": %s\n", this->global_cycle, file_name);
+};
+
+// =====================================================================
+void orcs_engine_t::checkpoint_restore(const char *file_name) {
+	checkpoint_t checkpoint;
+	checkpoint.allocate(file_name, false);
+	this->checkpoint(&checkpoint);
+	ORCS_PRINTF("Checkpoint restored at cycle %" PRIu64 ": %s\n", this->global_cycle, file_name);
+};
+
+// =====================================================================
+/// Fork one copy-on-write child per configuration from the current state.
+/// Returns true inside each child and false in the parent, once all the
+/// children finished. Each child writes its output on <config>.out
+bool orcs_engine_t::fork_configs() {
+	pid_t child_pid[MAX_FORK_CONFIGS];
+
+	if (this->arg_broadcast) {
+		this->broadcast = new trace_broadcast_t;
+		this->broadcast->allocate(this->config->broadcast_ring_batches, this->arg_total_fork_configs);
+	}
+
+	for (uint32_t i = 0; i < this->arg_total_fork_configs; i++) {
+		/// Nothing buffered may be printed twice
+		fflush(stdout);
+		child_pid[i] = fork();
+		ERROR_ASSERT_PRINTF(child_pid[i] >= 0, "Could not fork the configuration %s\n", this->arg_fork_config[i]);
+
+		if (child_pid[i] == 0) {
+			char output_file_name[TRACE_LINE_SIZE];
+			snprintf(output_file_name, sizeof(output_file_name), "%s.out", this->arg_fork_config[i]);
+			ERROR_ASSERT_PRINTF(freopen(output_file_name, "w", stdout) != NULL, "Could not open the output file.\n%s\n", output_file_name);
+
+			/// Attach first, a child failing in configure() must leave the ring
+			if (this->broadcast != NULL) {
+				this->broadcast->attach(i);
+				this->trace_reader->attach_broadcast(this->broadcast);
+			}
+			else {
+				this->trace_reader->detach_files();
+			}
+			this->arg_config_file_name = this->arg_fork_config[i];
+			this->configure(this->arg_config_file_name);
+			this->stats_page->fork_child(i);
+			ORCS_PRINTF("Forked at cycle %" PRIu64 " for configuration %s\n", this->global_cycle, this->arg_config_file_name);
+			return true;
+		}
+		ORCS_PRINTF("Configuration %s => pid %d\n", this->arg_fork_config[i], child_pid[i]);
+		if (this->broadcast != NULL) {
+			this->broadcast->set_consumer_pid(i, child_pid[i]);
+		}
+	}
+
+	/// The parent work ends with the warm-up
+	this->stats_page->finish();
+	if (this->broadcast != NULL) {
+		this->broadcast->produce();
+	}
+
+	for (uint32_t i = 0; i < this->arg_total_fork_configs; i++) {
+		int status = 0;
+		ERROR_ASSERT_PRINTF(waitpid(child_pid[i], &status, 0) == child_pid[i], "Could not wait the configuration %s\n", this->arg_fork_config[i]);
+		ORCS_PRINTF("Configuration %s => %s\n", this->arg_fork_config[i],
+					(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) ? "OK" : "FAIL");
+	}
+	if (this->broadcast != NULL) {
+		this->broadcast->statistics();
+	}
+	return false;
+};
@@ -1,3 +1,6 @@
+// ============================================================================
+#define MAX_FORK_CONFIGS 64
+
 // ============================================================================
 class orcs_engine_t {
 	private:
@@ -6,21 +9,60 @@ class orcs_engine_t {
     public:
         /// Program input
         char *arg_trace_file_name;
+        char *arg_stats_page_file_name;
+        char *arg_checkpoint_file_name;
+        char *arg_restore_file_name;
+        uint64_t arg_warmup_cycles;
+
+        /// One child is forked for each configuration after the warm-up
+        char *arg_fork_config[MAX_FORK_CONFIGS];
+        uint32_t arg_total_fork_configs;
+        char *arg_config_file_name;
+
+        /// Basic-block vectors / SimPoint regions
+        uint64_t arg_bbv_interval;
+        char *arg_bbv_output_name;
+        char *arg_region_file_name;
+        uint32_t arg_region_index;
+
+        /// The forked configurations share one trace decoder
+        bool arg_broadcast;
+
+        /// Prefetchers to evaluate (comma separated or "all")
+        char *arg_prefetch_eval;
 
         /// Control the Global Cycle
         uint64_t global_cycle;
 
         bool simulator_alive;
 
+        /// Microarchitecture parameters
+        config_t *config;
+
+        /// Arenas and pools get their memory here
+        allocator_t *allocator;
+
         /// Components modeled
         trace_reader_t *trace_reader;
         processor_t *processor;
+        memory_controller_t *memory;
+
+        /// Progress published to orcs-top
+        stats_page_t *stats_page;
+
+        /// Decode-once ring for the forked configurations (--broadcast)
+        trace_broadcast_t *broadcast;
 
 		// ====================================================================
 		/// Methods
 		// ====================================================================
 		orcs_engine_t();
 		void allocate();
+		void configure(const char *config_file_name);
+		void checkpoint(checkpoint_t *checkpoint);
+		void checkpoint_save(const char *file_name);
+		void checkpoint_restore(const char *file_name);
+		bool fork_configs();
         uint64_t get_global_cycle() {
             return this->global_cycle;
         };
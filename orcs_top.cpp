@@ -0,0 +1,163 @@
+/// orcs-top: attach to the stats pages of running simulations and show
+/// their progress. It only maps the pages read-only, the simulators are
+/// never stopped nor signaled.
+#include "simulator.hpp"
+
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+
+#define ORCS_TOP_MAX_PAGES 256
+#define ORCS_TOP_DEFAULT_DIR "/dev/shm"
+#define ORCS_TOP_DEFAULT_PREFIX "orcs."
+
+// =============================================================================
+struct orcs_top_page_t {
+    char file_name[TRACE_LINE_SIZE];
+    const stats_page_data_t *page;
+};
+
+static orcs_top_page_t top_pages[ORCS_TOP_MAX_PAGES];
+static uint32_t top_total_pages = 0;
+
+// =============================================================================
+static void display_use() {
+    ORCS_PRINTF("**** orcs-top - OrCS progress monitor ****\n\n");
+    ORCS_PRINTF("Usage: orcs-top [-i <interval_ms>] [-n <iterations>] [stats_page_file ...]\n");
+    ORCS_PRINTF("Without files, all %s/%s* pages are shown.\n", ORCS_TOP_DEFAULT_DIR, ORCS_TOP_DEFAULT_PREFIX);
+};
+
+// =============================================================================
+static void attach_page(const char *file_name) {
+    if (top_total_pages >= ORCS_TOP_MAX_PAGES) {
+        return;
+    }
+
+    int file_descriptor = open(file_name, O_RDONLY);
+    if (file_descriptor < 0) {
+        ORCS_PRINTF("Could not open %s\n", file_name);
+        return;
+    }
+    /// Reading past the end of a shorter file would raise SIGBUS
+    struct stat file_stat;
+    if (fstat(file_descriptor, &file_stat) != 0 || file_stat.st_size < (off_t)sizeof(stats_page_data_t)) {
+        ORCS_PRINTF("Skipping %s (not a stats page)\n", file_name);
+        close(file_descriptor);
+        return;
+    }
+    void *map = mmap(NULL, sizeof(stats_page_data_t), PROT_READ, MAP_SHARED, file_descriptor, 0);
+    close(file_descriptor);
+    if (map == MAP_FAILED) {
+        ORCS_PRINTF("Could not map %s\n", file_name);
+        return;
+    }
+
+    snprintf(top_pages[top_total_pages].file_name, TRACE_LINE_SIZE, "%s", file_name);
+    top_pages[top_total_pages].page = (const stats_page_data_t*)map;
+    top_total_pages++;
+};
+
+// =============================================================================
+static void attach_default_pages() {
+    DIR *directory = opendir(ORCS_TOP_DEFAULT_DIR);
+    if (directory == NULL) {
+        return;
+    }
+
+    char file_name[TRACE_LINE_SIZE];
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (strncmp(entry->d_name, ORCS_TOP_DEFAULT_PREFIX, strlen(ORCS_TOP_DEFAULT_PREFIX)) == 0) {
+            snprintf(file_name, sizeof(file_name), "%s/%s", ORCS_TOP_DEFAULT_DIR, entry->d_name);
+            attach_page(file_name);
+        }
+    }
+    closedir(directory);
+};
+
+// =============================================================================
+static void display_pages() {
+    stats_page_data_t copy;
+
+    ORCS_PRINTF("%-8s %-6s %16s %16s %10s %8s %10s  %s\n",
+                    "PID", "STATE", "CYCLE", "INSTRUCTIONS", "BBL", "MIPS", "ELAPSED", "TRACE");
+
+    for (uint32_t i = 0; i < top_total_pages; i++) {
+        bool is_consistent;
+        if (!stats_page_read(top_pages[i].page, &copy, &is_consistent)) {
+            ORCS_PRINTF("%-8s %-6s %s\n", "-", "N/A", top_pages[i].file_name);
+            continue;
+        }
+
+        bool is_dead = (kill(copy.pid, 0) != 0 && errno == ESRCH);
+        const char *state = "RUN";
+        if (!is_consistent) {
+            /// Stuck in an update: killed while writing, or still writing
+            state = is_dead ? "DEAD" : "TORN";
+        }
+        else if (!copy.simulator_alive) {
+            state = "DONE";
+        }
+        else if (is_dead) {
+            state = "DEAD";
+        }
+
+        ORCS_PRINTF("%-8u %-6s %16" PRIu64 " %16" PRIu64 " %10u %8.2f %9" PRIu64 "s  %s\n",
+                        copy.pid, state, copy.global_cycle, copy.fetch_instructions,
+                        copy.current_bbl, copy.mips,
+                        (copy.update_time_us - copy.start_time_us) / 1000000,
+                        copy.trace_file_name);
+
+        for (uint32_t c = 0; c < copy.total_counters && c < STATS_PAGE_MAX_COUNTERS; c++) {
+            ORCS_PRINTF("%15s %-32s %" PRIu64 "\n", "", copy.counter[c].name, copy.counter[c].value);
+        }
+    }
+};
+
+// =============================================================================
+int main(int argc, char **argv) {
+    uint32_t interval_ms = 1000;
+    uint32_t iterations = 0;        /// 0 = forever
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hi:n:")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval_ms = strtoul(optarg, NULL, 10);
+            break;
+
+        case 'n':
+            iterations = strtoul(optarg, NULL, 10);
+            break;
+
+        default:
+            display_use();
+            return(EXIT_FAILURE);
+        }
+    }
+
+    while (optind < argc) {
+        attach_page(argv[optind++]);
+    }
+    if (top_total_pages == 0) {
+        attach_default_pages();
+    }
+    if (top_total_pages == 0) {
+        ORCS_PRINTF("No stats page found.\n");
+        display_use();
+        return(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; iterations == 0 || i < iterations; i++) {
+        if (iterations != 1) {
+            ORCS_PRINTF("\033[H\033[2J");   /// Clear the terminal
+        }
+        display_pages();
+        fflush(stdout);
+        if (iterations == 0 || i + 1 < iterations) {
+            usleep(interval_ms * 1000);
+        }
+    }
+
+    return(EXIT_SUCCESS);
+};
@@ -0,0 +1,299 @@
+/// orcs-trace-slice: cut an instruction or BBL range out of a trace into a
+/// new, self-consistent trace (static, dynamic and memory files).
+/// The input is decoded by trace_reader_t, so the memory stream always
+/// follows the dynamic one; the slice is streamed to the output files
+/// and only the static dictionary is kept in memory.
+///
+/// The slice holds whole BBLs: an instruction range starts at the first
+/// BBL beginning at or after --start and ends at the first BBL boundary
+/// at or after --start + --length. With --prune the static file keeps
+/// only the BBLs used, renumbered 1..N in order of first use (the
+/// dynamic and memory files are rewritten with the new numbers);
+/// otherwise it is copied as is.
+#include "simulator.hpp"
+
+orcs_engine_t orcs_engine;
+
+#define SLICE_COPY_BUFFER_SIZE (1 << 20)
+
+// =============================================================================
+static char *slice_trace_name = NULL;
+static char *slice_output_name = NULL;
+static uint64_t slice_start = 0;
+static uint64_t slice_length = UINT64_MAX;
+static bool slice_in_bbls = false;
+static bool slice_prune = false;
+
+// =============================================================================
+static void display_use() {
+    ORCS_PRINTF("**** orcs-trace-slice - OrCS trace slicer ****\n\n");
+    ORCS_PRINTF("Usage: orcs-trace-slice -t <trace_basename> -o <output_basename> [-s <start>] [-l <length>] [-b] [-p]\n");
+    ORCS_PRINTF("    -s/-l   range in instructions (whole BBLs are kept), or in BBLs with -b\n");
+    ORCS_PRINTF("    -p      prune the static file to the BBLs used\n");
+};
+
+// =============================================================================
+static void process_argv(int argc, char **argv) {
+    static struct option long_options[] = {
+        {"help",    no_argument, 0, 'h'},
+        {"trace",   required_argument, 0, 't'},
+        {"output",  required_argument, 0, 'o'},
+        {"start",   required_argument, 0, 's'},
+        {"length",  required_argument, 0, 'l'},
+        {"bbl",     no_argument, 0, 'b'},
+        {"prune",   no_argument, 0, 'p'},
+        {NULL,      0, NULL, 0}
+    };
+
+    int opt;
+    int option_index = 0;
+    while ((opt = getopt_long_only(argc, argv, "ht:o:s:l:bp", long_options, &option_index)) != -1) {
+        switch (opt) {
+        case 't':
+            slice_trace_name = optarg;
+            break;
+
+        case 'o':
+            slice_output_name = optarg;
+            break;
+
+        case 's':
+            slice_start = strtoull(optarg, NULL, 10);
+            break;
+
+        case 'l':
+            slice_length = strtoull(optarg, NULL, 10);
+            break;
+
+        case 'b':
+            slice_in_bbls = true;
+            break;
+
+        case 'p':
+            slice_prune = true;
+            break;
+
+        default:
+            display_use();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (slice_trace_name == NULL || slice_output_name == NULL) {
+        display_use();
+        exit(EXIT_FAILURE);
+    }
+};
+
+// =============================================================================
+static gzFile slice_open(const char *basename, const char *kind, const char *mode) {
+    char file_name[TRACE_LINE_SIZE];
+    snprintf(file_name, sizeof(file_name), "%s.tid0.%s.out.gz", basename, kind);
+    gzFile file = gzopen(file_name, mode);
+    ERROR_ASSERT_PRINTF(file != NULL, "Could not open the %s file.\n%s\n", kind, file_name);
+    return file;
+};
+
+// =============================================================================
+static void slice_write(gzFile file, const char *text, uint32_t length) {
+    ERROR_ASSERT_PRINTF(gzwrite(file, text, length) == (int)length, "Could not write the output trace.\n");
+};
+
+// =============================================================================
+static void slice_write_header(gzFile file) {
+    char header[TRACE_LINE_SIZE * 2];
+    uint32_t length = snprintf(header, sizeof(header), "#\n# Sliced by orcs-trace-slice from %s\n#\n", slice_trace_name);
+    slice_write(file, header, length);
+};
+
+// =============================================================================
+static void slice_write_memory(gzFile file, char operation, uint32_t size, uint64_t address, uint32_t bbl) {
+    char line[64];
+    uint32_t length = snprintf(line, sizeof(line), "%c %u %" PRIu64 " %u\n", operation, size, address, bbl);
+    slice_write(file, line, length);
+};
+
+// =============================================================================
+/// Copy the static file unchanged
+static void slice_copy_static(gzFile output) {
+    gzFile input = slice_open(slice_trace_name, "stat", "rb");
+    char *buffer = new char[SLICE_COPY_BUFFER_SIZE];
+    ERROR_ASSERT_PRINTF(buffer != NULL, "Could not allocate memory\n");
+
+    int length;
+    while ((length = gzread(input, buffer, SLICE_COPY_BUFFER_SIZE)) > 0) {
+        slice_write(output, buffer, length);
+    }
+    ERROR_ASSERT_PRINTF(length == 0, "Could not read the static file.\n");
+
+    delete[] buffer;
+    gzclose(input);
+};
+
+// =============================================================================
+/// Write the used BBLs only, old_bbl[1..total_used] in the new order.
+/// The text of the used BBLs is kept in an arena while the input is read.
+static void slice_prune_static(gzFile output, uint32_t *new_bbl, uint32_t *old_bbl, uint32_t total_used) {
+    trace_reader_t *trace_reader = orcs_engine.trace_reader;
+    uint32_t total_bbls = trace_reader->get_binary_total_bbls();
+    gzFile input = slice_open(slice_trace_name, "stat", "rb");
+
+    arena_t arena;
+    arena.allocate(ALLOCATION_TRACE_STRINGS);
+    char ***static_line = new char**[total_bbls];
+    ERROR_ASSERT_PRINTF(static_line != NULL, "Could not allocate memory\n");
+    memset(static_line, 0, sizeof(char**) * total_bbls);
+
+    char file_line[TRACE_LINE_SIZE];
+    uint32_t bbl = 0;
+    uint32_t opcode = 0;
+    while (gzgets(input, file_line, TRACE_LINE_SIZE) != NULL) {
+        if (file_line[0] == '\0' || file_line[0] == '#') {
+            continue;
+        }
+        else if (file_line[0] == '@') {
+            bbl = (uint32_t)strtoul(file_line + 1, NULL, 10);
+            ERROR_ASSERT_PRINTF(bbl < total_bbls, "Static file changed while slicing.\n");
+            opcode = 0;
+            if (new_bbl[bbl] != 0) {
+                static_line[bbl] = arena.allocate_array<char*>(trace_reader->get_bbl_size(bbl));
+            }
+        }
+        else if (static_line[bbl] != NULL) {
+            ERROR_ASSERT_PRINTF(opcode < trace_reader->get_bbl_size(bbl), "Static file changed while slicing.\n");
+            uint32_t length = strcspn(file_line, "\r\n");
+            char *line = (char*)arena.allocate_bytes(length + 1, 1);
+            memcpy(line, file_line, length);
+            line[length] = '\0';
+            static_line[bbl][opcode++] = line;
+        }
+    }
+    gzclose(input);
+
+    /// No newline after the last instruction, the static parser needs it
+    slice_write_header(output);
+    char text[TRACE_LINE_SIZE];
+    for (uint32_t i = 1; i <= total_used; i++) {
+        uint32_t old = old_bbl[i];
+        uint32_t length = snprintf(text, sizeof(text), "%s@%u", (i == 1) ? "" : "\n", i);
+        slice_write(output, text, length);
+        for (uint32_t j = 0; j < trace_reader->get_bbl_size(old); j++) {
+            slice_write(output, "\n", 1);
+            slice_write(output, static_line[old][j], strlen(static_line[old][j]));
+        }
+    }
+    delete[] static_line;
+};
+
+// =============================================================================
+int main(int argc, char **argv) {
+    process_argv(argc, argv);
+
+    orcs_engine.allocate();
+    orcs_engine.trace_reader->allocate(slice_trace_name);
+    trace_reader_t *trace_reader = orcs_engine.trace_reader;
+    opcode_package_t instruction;
+
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);
+
+    /// Move to the first BBL of the slice
+    uint64_t skipped_bbls = 0;
+    if (slice_in_bbls) {
+        while (skipped_bbls < slice_start && trace_reader->trace_fetch(&instruction)) {
+            skipped_bbls += trace_reader->is_bbl_boundary();
+        }
+    }
+    else {
+        trace_reader->trace_skip(slice_start);
+        while (!trace_reader->is_bbl_boundary() && trace_reader->trace_fetch(&instruction)) {
+        }
+    }
+    uint64_t first_instruction = trace_reader->get_fetch_instructions();
+
+    /// BBL numbers in the output (identity without pruning)
+    uint32_t total_bbls = trace_reader->get_binary_total_bbls();
+    uint32_t *new_bbl = new uint32_t[total_bbls];
+    uint32_t *old_bbl = new uint32_t[total_bbls];
+    ERROR_ASSERT_PRINTF(new_bbl != NULL && old_bbl != NULL, "Could not allocate memory\n");
+    memset(new_bbl, 0, sizeof(uint32_t) * total_bbls);
+    uint32_t total_used = 0;
+
+    /// Fastest compression level: the output is re-read once and should
+    /// not slow down the decoding of the input
+    gzFile dynamic_file = slice_open(slice_output_name, "dyn", "wb1");
+    gzFile memory_file = slice_open(slice_output_name, "mem", "wb1");
+    slice_write_header(dynamic_file);
+    slice_write_header(memory_file);
+
+    uint64_t total_instructions = 0;
+    uint64_t total_slice_bbls = 0;
+    uint64_t total_memory = 0;
+    uint32_t bbl = 0;
+    for (;;) {
+        bool is_boundary = trace_reader->is_bbl_boundary();
+        if (is_boundary && (slice_in_bbls ? total_slice_bbls : total_instructions) >= slice_length) {
+            break;
+        }
+        if (!trace_reader->trace_fetch(&instruction)) {
+            break;
+        }
+
+        if (is_boundary) {
+            uint32_t current = trace_reader->get_current_bbl();
+            if (new_bbl[current] == 0) {
+                new_bbl[current] = slice_prune ? total_used + 1 : current;
+                old_bbl[++total_used] = current;
+            }
+            bbl = new_bbl[current];
+
+            char line[32];
+            uint32_t length = snprintf(line, sizeof(line), "%u\n", bbl);
+            slice_write(dynamic_file, line, length);
+            total_slice_bbls++;
+        }
+
+        if (instruction.is_read) {
+            slice_write_memory(memory_file, 'R', instruction.read_size, instruction.read_address, bbl);
+            total_memory++;
+        }
+        if (instruction.is_read2) {
+            slice_write_memory(memory_file, 'R', instruction.read2_size, instruction.read2_address, bbl);
+            total_memory++;
+        }
+        if (instruction.is_write) {
+            slice_write_memory(memory_file, 'W', instruction.write_size, instruction.write_address, bbl);
+            total_memory++;
+        }
+        total_instructions++;
+    }
+    gzclose(dynamic_file);
+    gzclose(memory_file);
+
+    gzFile static_file = slice_open(slice_output_name, "stat", "wb");
+    if (slice_prune) {
+        slice_prune_static(static_file, new_bbl, old_bbl, total_used);
+    }
+    else {
+        slice_copy_static(static_file);
+    }
+    gzclose(static_file);
+
+    gettimeofday(&end_time, NULL);
+    double seconds = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_usec - start_time.tv_usec) / 1e6;
+
+    ORCS_PRINTF("######################################################\n");
+    ORCS_PRINTF("orcs_trace_slice\n");
+    ORCS_PRINTF("output:%s\n", slice_output_name);
+    ORCS_PRINTF("first_instruction:%" PRIu64 "\n", first_instruction);
+    ORCS_PRINTF("instructions:%" PRIu64 "\n", total_instructions);
+    ORCS_PRINTF("bbls:%" PRIu64 "\n", total_slice_bbls);
+    ORCS_PRINTF("memory_operations:%" PRIu64 "\n", total_memory);
+    ORCS_PRINTF("static_bbls:%u\n", slice_prune ? total_used : total_bbls - 1);
+    ORCS_PRINTF("elapsed_seconds:%.2f\n", seconds);
+    ORCS_PRINTF("input_mips:%.2f\n", seconds > 0 ? trace_reader->get_fetch_instructions() / seconds / 1e6 : 0.0);
+
+    delete[] new_bbl;
+    delete[] old_bbl;
+    return(EXIT_SUCCESS);
+};
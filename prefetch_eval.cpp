@@ -0,0 +1,196 @@
+#include "simulator.hpp"
+
+// =====================================================================
+prefetch_evaluator_t::prefetch_evaluator_t() {
+    this->total_entries = 0;
+    this->demand_accesses = 0;
+};
+
+// =====================================================================
+prefetch_evaluator_t::~prefetch_evaluator_t() {
+    for (uint32_t i = 0; i < this->total_entries; i++) {
+        delete this->entry[i].prefetcher;
+    }
+};
+
+// =====================================================================
+/// Keys accepted after a prefetcher name, as prefetcher.<key>
+static const char *prefetch_eval_key[] = {
+    "degree",
+    "table_size",
+    "streams",
+    "ghb_size"
+};
+
+// =====================================================================
+void prefetch_evaluator_t::add_entry(prefetcher_type_t type, config_t *config, const char *suffix) {
+    ERROR_ASSERT_PRINTF(this->total_entries < PREFETCH_EVAL_MAX_PREFETCHERS, "Too many prefetchers to evaluate (max %u).\n", PREFETCH_EVAL_MAX_PREFETCHERS);
+    prefetch_eval_entry_t *current = &this->entry[this->total_entries];
+    current->prefetcher = prefetcher_t::create(type, config);
+    current->shadow.allocate(config->get_l1d_sets(), config->l1d_associativity, config->l1d_line_size);
+    current->stat_issued = 0;
+    current->stat_redundant = 0;
+    current->stat_useful = 0;
+    current->stat_late = 0;
+    current->stat_distance = 0;
+
+    /// Same name twice (e.g. stride,stride): number the copies
+    snprintf(current->name, PREFETCH_EVAL_NAME_SIZE, "%s%s", current->prefetcher->get_name(), suffix);
+    uint32_t length = strlen(current->name);
+    uint32_t copies = 1;
+    for (uint32_t i = 0; i < this->total_entries; i++) {
+        const char *other = this->entry[i].name;
+        if (strncmp(other, current->name, length) == 0 &&
+            (other[length] == '\0' || (other[length] == '_' && other[length + 1] != '\0' &&
+                                        strspn(other + length + 1, "0123456789") == strlen(other + length + 1)))) {
+            copies++;
+        }
+    }
+    if (copies > 1) {
+        char name[PREFETCH_EVAL_NAME_SIZE];
+        snprintf(name, sizeof(name), "%s", current->name);
+        snprintf(current->name, PREFETCH_EVAL_NAME_SIZE, "%.48s_%u", name, copies);
+    }
+    this->total_entries++;
+};
+
+// =====================================================================
+/// prefetcher_list: comma separated <name>[:<key>=<value>...] entries
+void prefetch_evaluator_t::allocate(const char *prefetcher_list) {
+    config_t *config = orcs_engine.config;
+    char list[TRACE_LINE_SIZE];
+    snprintf(list, sizeof(list), "%s", prefetcher_list);
+
+    this->baseline.allocate(config->get_l1d_sets(), config->l1d_associativity, config->l1d_line_size);
+
+    char *save = NULL;
+    for (char *item = strtok_r(list, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save)) {
+        char *item_save = NULL;
+        char *name = strtok_r(item, ":", &item_save);
+        ERROR_ASSERT_PRINTF(name != NULL, "Empty prefetcher in \"%s\".\n", prefetcher_list);
+
+        prefetcher_type_t first, last;
+        if (strcmp(name, "all") == 0) {
+            first = PREFETCHER_STRIDE;
+            last = PREFETCHER_CORRELATION;
+        }
+        else {
+            ERROR_ASSERT_PRINTF(prefetcher_t::find_type(name, &first) == OK, "Unknown prefetcher \"%s\" (stride, stream, ghb, correlation or all).\n", name);
+            last = first;
+        }
+
+        /// Own copy of the configuration, with this entry's overrides
+        config_t entry_config;
+        entry_config.allocate(orcs_engine.arg_config_file_name);
+        char suffix[PREFETCH_EVAL_NAME_SIZE] = "";
+        for (char *option = strtok_r(NULL, ":", &item_save); option != NULL; option = strtok_r(NULL, ":", &item_save)) {
+            char *value = strchr(option, '=');
+            ERROR_ASSERT_PRINTF(value != NULL, "Prefetcher %s: expected \"key=value\", got \"%s\".\n", name, option);
+            *value++ = '\0';
+
+            bool is_known = false;
+            for (uint32_t k = 0; k < sizeof(prefetch_eval_key) / sizeof(prefetch_eval_key[0]); k++) {
+                is_known |= (strcmp(option, prefetch_eval_key[k]) == 0);
+            }
+            ERROR_ASSERT_PRINTF(is_known, "Prefetcher %s: unknown key \"%s\" (degree, table_size, streams or ghb_size).\n", name, option);
+
+            char parameter[PREFETCH_EVAL_NAME_SIZE];
+            snprintf(parameter, sizeof(parameter), "prefetcher.%s", option);
+            entry_config.override_parameter(parameter, value);
+
+            uint32_t length = strlen(suffix);
+            snprintf(suffix + length, sizeof(suffix) - length, "_%s%s", option, value);
+        }
+
+        for (uint32_t type = first; type <= (uint32_t)last; type++) {
+            this->add_entry(prefetcher_type_t(type), &entry_config, suffix);
+        }
+    }
+    ERROR_ASSERT_PRINTF(this->total_entries > 0, "No prefetcher to evaluate.\n");
+};
+
+// =====================================================================
+void prefetch_evaluator_t::access(uint64_t pc, uint64_t address) {
+    uint64_t prefetch[PREFETCH_MAX_DEGREE];
+    uint64_t prefetch_stamp;
+
+    this->demand_accesses++;
+    this->baseline.access(address);
+
+    for (uint32_t i = 0; i < this->total_entries; i++) {
+        prefetch_eval_entry_t *current = &this->entry[i];
+        bool is_hit = current->shadow.access_prefetch(address, &prefetch_stamp);
+
+        if (prefetch_stamp != 0) {
+            uint64_t distance = this->demand_accesses - prefetch_stamp;
+            current->stat_useful++;
+            current->stat_distance += distance;
+            if (distance < PREFETCH_EVAL_LATE_DISTANCE) {
+                current->stat_late++;
+            }
+        }
+
+        uint32_t total = current->prefetcher->access(pc, address, !is_hit || prefetch_stamp != 0, prefetch);
+        for (uint32_t p = 0; p < total; p++) {
+            if (current->shadow.prefetch(prefetch[p], this->demand_accesses)) {
+                current->stat_issued++;
+            }
+            else {
+                current->stat_redundant++;
+            }
+        }
+    }
+};
+
+// =====================================================================
+void prefetch_evaluator_t::run() {
+    trace_reader_t *trace_reader = orcs_engine.trace_reader;
+    opcode_package_t instruction;
+
+    while (trace_reader->trace_fetch(&instruction)) {
+        /// Near-memory operations never reach the L1D
+        if (instruction.opcode_operation == INSTRUCTION_OPERATION_HMC_ROA ||
+            instruction.opcode_operation == INSTRUCTION_OPERATION_HMC_ROWA) {
+            continue;
+        }
+        if (instruction.is_read) {
+            this->access(instruction.opcode_address, instruction.read_address);
+        }
+        if (instruction.is_read2) {
+            this->access(instruction.opcode_address, instruction.read2_address);
+        }
+        if (instruction.is_write) {
+            this->access(instruction.opcode_address, instruction.write_address);
+        }
+    }
+};
+
+// =====================================================================
+void prefetch_evaluator_t::statistics() {
+    uint64_t baseline_misses = this->baseline.stat_misses;
+
+    ORCS_PRINTF("######################################################\n");
+    ORCS_PRINTF("prefetch_evaluator_t\n");
+    ORCS_PRINTF("demand_accesses:%" PRIu64 "\n", this->demand_accesses);
+    this->baseline.statistics("baseline");
+
+    for (uint32_t i = 0; i < this->total_entries; i++) {
+        prefetch_eval_entry_t *current = &this->entry[i];
+        const char *name = current->name;
+        uint64_t misses = current->shadow.stat_misses;
+
+        current->shadow.statistics(name);
+        ORCS_PRINTF("%s_issued:%" PRIu64 "\n", name, current->stat_issued);
+        ORCS_PRINTF("%s_redundant:%" PRIu64 "\n", name, current->stat_redundant);
+        ORCS_PRINTF("%s_useful:%" PRIu64 "\n", name, current->stat_useful);
+        ORCS_PRINTF("%s_unused_evicted:%" PRIu64 "\n", name, current->shadow.stat_prefetch_unused);
+        ORCS_PRINTF("%s_accuracy:%.4f\n", name,
+                    current->stat_issued ? (double)current->stat_useful / current->stat_issued : 0.0);
+        ORCS_PRINTF("%s_coverage:%.4f\n", name,
+                    baseline_misses ? ((double)baseline_misses - (double)misses) / baseline_misses : 0.0);
+        ORCS_PRINTF("%s_avg_use_distance:%.2f\n", name,
+                    current->stat_useful ? (double)current->stat_distance / current->stat_useful : 0.0);
+        ORCS_PRINTF("%s_late_fraction:%.4f\n", name,
+                    current->stat_useful ? (double)current->stat_late / current->stat_useful : 0.0);
+    }
+};
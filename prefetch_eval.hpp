@@ -0,0 +1,64 @@
+// ============================================================================
+// ============================================================================
+/// Prefetcher evaluation.
+/// One pass over the trace drives a bank of independent (prefetcher,
+/// shadow cache) pairs plus a baseline shadow cache without prefetcher,
+/// all with the L1D geometry. Each data access (read, read2, write) is
+/// tagged with its instruction address. Prefetches are filled at once
+/// and stamped with the index of the access that issued them, so on the
+/// first use the distance in demand accesses measures how early it was.
+///
+/// Per prefetcher:
+///     accuracy    useful / issued
+///     coverage    (baseline misses - misses) / baseline misses
+///     timeliness  average issue-to-use distance, and the fraction of
+///                 useful prefetches used within PREFETCH_EVAL_LATE_DISTANCE
+///                 accesses (likely late in a timing model)
+///
+/// HMC operations bypass the L1D in the timing model, so they are not
+/// evaluated either.
+///
+/// The bank is a comma separated list of <name>[:<key>=<value>...], where
+/// name is a prefetcher or "all" and the keys override the prefetcher.*
+/// parameters of the loaded configuration for that entry only, e.g.
+///     -e stride,stride:degree=8,ghb:table_size=1024:ghb_size=2048
+/// Each entry is reported as its name followed by its overrides
+/// (stride, stride_degree8, ...).
+#define PREFETCH_EVAL_MAX_PREFETCHERS 16
+#define PREFETCH_EVAL_NAME_SIZE 64
+#define PREFETCH_EVAL_LATE_DISTANCE 8
+
+// ============================================================================
+struct prefetch_eval_entry_t {
+    prefetcher_t *prefetcher;
+    char name[PREFETCH_EVAL_NAME_SIZE];
+    cache_t shadow;
+
+    uint64_t stat_issued;           /// Filled in the shadow cache
+    uint64_t stat_redundant;        /// Already present, dropped
+    uint64_t stat_useful;           /// First demand hit on a prefetched line
+    uint64_t stat_late;             /// Useful within PREFETCH_EVAL_LATE_DISTANCE
+    uint64_t stat_distance;         /// Sum of the issue-to-use distances
+};
+
+// ============================================================================
+class prefetch_evaluator_t {
+    private:
+        cache_t baseline;
+        prefetch_eval_entry_t entry[PREFETCH_EVAL_MAX_PREFETCHERS];
+        uint32_t total_entries;
+        uint64_t demand_accesses;
+
+        void access(uint64_t pc, uint64_t address);
+        void add_entry(prefetcher_type_t type, config_t *config, const char *suffix);
+
+    public:
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        prefetch_evaluator_t();
+        ~prefetch_evaluator_t();
+        void allocate(const char *prefetcher_list);
+        void run();
+        void statistics();
+};
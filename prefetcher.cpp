@@ -0,0 +1,313 @@
+#include "simulator.hpp"
+
+// =====================================================================
+static const char *prefetcher_name[PREFETCHER_TOTAL] = {
+    "stride",
+    "stream",
+    "ghb",
+    "correlation"
+};
+
+// =====================================================================
+bool prefetcher_t::find_type(const char *name, prefetcher_type_t *type) {
+    for (uint32_t i = 0; i < PREFETCHER_TOTAL; i++) {
+        if (strcmp(prefetcher_name[i], name) == 0) {
+            *type = prefetcher_type_t(i);
+            return OK;
+        }
+    }
+    return FAIL;
+};
+
+// =====================================================================
+prefetcher_t *prefetcher_t::create(prefetcher_type_t type, config_t *config) {
+    prefetcher_t *prefetcher = NULL;
+
+    switch (type) {
+        case PREFETCHER_STRIDE:
+            prefetcher = new stride_prefetcher_t(config->l1d_line_size, config->prefetcher_degree, config->prefetcher_table_size);
+        break;
+        case PREFETCHER_STREAM:
+            prefetcher = new stream_prefetcher_t(config->l1d_line_size, config->prefetcher_degree, config->prefetcher_streams);
+        break;
+        case PREFETCHER_GHB:
+            prefetcher = new ghb_prefetcher_t(config->l1d_line_size, config->prefetcher_degree, config->prefetcher_table_size, config->prefetcher_ghb_size);
+        break;
+        case PREFETCHER_CORRELATION:
+            prefetcher = new correlation_prefetcher_t(config->l1d_line_size, config->prefetcher_degree, config->prefetcher_table_size);
+        break;
+        case PREFETCHER_TOTAL:
+            ERROR_PRINTF("Invalid prefetcher type.\n");
+        break;
+    }
+    ERROR_ASSERT_PRINTF(prefetcher != NULL, "Could not allocate memory\n");
+    return prefetcher;
+};
+
+// =====================================================================
+stride_prefetcher_t::stride_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t entries)
+    : prefetcher_t(line_bytes, prefetch_degree, entries) {
+    this->table = new stride_entry_t[entries];
+    ERROR_ASSERT_PRINTF(this->table != NULL, "Could not allocate memory\n");
+    memset(this->table, 0, sizeof(stride_entry_t) * entries);
+};
+
+// =====================================================================
+stride_prefetcher_t::~stride_prefetcher_t() {
+    delete[] this->table;
+};
+
+// =====================================================================
+/// Two consecutive equal strides arm the entry, a different stride
+/// lowers the confidence and replaces it once the confidence is gone
+uint32_t stride_prefetcher_t::access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch) {
+    (void)is_trigger;
+    stride_entry_t *entry = &this->table[prefetch_hash(pc, this->table_size)];
+    uint32_t total = 0;
+
+    if (entry->pc != pc) {
+        entry->pc = pc;
+        entry->last_address = address;
+        entry->stride = 0;
+        entry->confidence = 0;
+        return 0;
+    }
+
+    int64_t stride = (int64_t)(address - entry->last_address);
+    if (stride == entry->stride) {
+        if (entry->confidence < 3) {
+            entry->confidence++;
+        }
+    }
+    else if (entry->confidence > 0) {
+        entry->confidence--;
+    }
+    else {
+        entry->stride = stride;
+    }
+    entry->last_address = address;
+
+    if (entry->confidence >= 2 && entry->stride != 0) {
+        for (uint32_t i = 1; i <= this->degree; i++) {
+            total = this->add_prefetch(prefetch, total, address + entry->stride * (int64_t)i);
+        }
+    }
+    return total;
+};
+
+// =====================================================================
+stream_prefetcher_t::stream_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t streams)
+    : prefetcher_t(line_bytes, prefetch_degree, streams) {
+    this->total_streams = streams;
+    this->use_stamp = 0;
+    this->stream = new stream_entry_t[streams];
+    ERROR_ASSERT_PRINTF(this->stream != NULL, "Could not allocate memory\n");
+    memset(this->stream, 0, sizeof(stream_entry_t) * streams);
+};
+
+// =====================================================================
+stream_prefetcher_t::~stream_prefetcher_t() {
+    delete[] this->stream;
+};
+
+// =====================================================================
+/// A trigger near a stream head moves the head and, once the direction
+/// repeats, prefetches the next lines; otherwise it starts a new stream
+/// on the least recently used entry
+uint32_t stream_prefetcher_t::access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch) {
+    (void)pc;
+    if (!is_trigger) {
+        return 0;
+    }
+
+    uint64_t line = address / this->line_size;
+    stream_entry_t *victim = &this->stream[0];
+    uint32_t total = 0;
+    this->use_stamp++;
+
+    for (uint32_t i = 0; i < this->total_streams; i++) {
+        stream_entry_t *entry = &this->stream[i];
+        int64_t distance = (int64_t)(line - entry->last_line);
+        if (entry->last_use != 0 && distance != 0 &&
+            distance <= PREFETCH_STREAM_WINDOW && distance >= -PREFETCH_STREAM_WINDOW) {
+            int64_t direction = (distance > 0) ? 1 : -1;
+            if (direction == entry->direction) {
+                if (entry->confidence < 3) {
+                    entry->confidence++;
+                }
+            }
+            else {
+                entry->direction = direction;
+                entry->confidence = 0;
+            }
+            entry->last_line = line;
+            entry->last_use = this->use_stamp;
+
+            if (entry->confidence >= 1) {
+                for (uint32_t d = 1; d <= this->degree; d++) {
+                    total = this->add_prefetch(prefetch, total, (line + direction * (int64_t)d) * this->line_size);
+                }
+            }
+            return total;
+        }
+        if (entry->last_use < victim->last_use) {
+            victim = entry;
+        }
+    }
+
+    victim->last_line = line;
+    victim->direction = 0;
+    victim->confidence = 0;
+    victim->last_use = this->use_stamp;
+    return 0;
+};
+
+// =====================================================================
+ghb_prefetcher_t::ghb_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t entries, uint32_t history_entries)
+    : prefetcher_t(line_bytes, prefetch_degree, entries) {
+    this->history_size = history_entries;
+    this->next_sequence = 1;
+    this->history = new ghb_entry_t[history_entries];
+    this->index = new ghb_index_t[entries];
+    ERROR_ASSERT_PRINTF(this->history != NULL && this->index != NULL, "Could not allocate memory\n");
+    memset(this->history, 0, sizeof(ghb_entry_t) * history_entries);
+    memset(this->index, 0, sizeof(ghb_index_t) * entries);
+};
+
+// =====================================================================
+ghb_prefetcher_t::~ghb_prefetcher_t() {
+    delete[] this->history;
+    delete[] this->index;
+};
+
+// =====================================================================
+/// Insert the miss, rebuild the PC delta history through the GHB links
+/// and look for the most recent earlier occurrence of the last two
+/// deltas; the deltas that followed it are replayed from this miss
+uint32_t ghb_prefetcher_t::access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch) {
+    if (!is_trigger) {
+        return 0;
+    }
+
+    uint64_t line = address / this->line_size;
+    ghb_index_t *pc_index = &this->index[prefetch_hash(pc, this->table_size)];
+    if (pc_index->pc != pc) {
+        pc_index->pc = pc;
+        pc_index->last = 0;
+    }
+
+    uint64_t sequence = this->next_sequence++;
+    ghb_entry_t *entry = &this->history[sequence % this->history_size];
+    entry->line = line;
+    entry->sequence = sequence;
+    entry->previous = pc_index->last;
+    pc_index->last = sequence;
+
+    /// lines[0] is this miss, older ones follow
+    uint64_t lines[PREFETCH_GHB_HISTORY + 1];
+    uint32_t total_lines = 0;
+    uint64_t walk = sequence;
+    while (walk != 0 && total_lines <= PREFETCH_GHB_HISTORY) {
+        ghb_entry_t *old = &this->history[walk % this->history_size];
+        if (old->sequence != walk) {
+            break;      /// Overwritten
+        }
+        lines[total_lines++] = old->line;
+        walk = old->previous;
+    }
+    if (total_lines < 4) {
+        return 0;
+    }
+
+    int64_t delta[PREFETCH_GHB_HISTORY];
+    uint32_t total_deltas = total_lines - 1;
+    for (uint32_t i = 0; i < total_deltas; i++) {
+        delta[i] = (int64_t)(lines[i] - lines[i + 1]);
+    }
+
+    uint32_t total = 0;
+    for (uint32_t j = 1; j + 1 < total_deltas; j++) {
+        if (delta[j] == delta[0] && delta[j + 1] == delta[1]) {
+            uint64_t target = line;
+            for (int32_t k = j - 1; k >= 0 && total < this->degree; k--) {
+                target += delta[k];
+                total = this->add_prefetch(prefetch, total, target * this->line_size);
+            }
+            break;
+        }
+    }
+    return total;
+};
+
+// =====================================================================
+correlation_prefetcher_t::correlation_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t entries)
+    : prefetcher_t(line_bytes, prefetch_degree, entries) {
+    this->pc_table = new correlation_pc_t[entries];
+    this->table = new correlation_entry_t[4 * entries];
+    ERROR_ASSERT_PRINTF(this->pc_table != NULL && this->table != NULL, "Could not allocate memory\n");
+    memset(this->pc_table, 0, sizeof(correlation_pc_t) * entries);
+    for (uint32_t i = 0; i < 4 * entries; i++) {
+        this->table[i].key = PREFETCH_NONE;
+        for (uint32_t w = 0; w < PREFETCH_CORRELATION_WAYS; w++) {
+            this->table[i].successor[w] = PREFETCH_NONE;
+        }
+    }
+};
+
+// =====================================================================
+correlation_prefetcher_t::~correlation_prefetcher_t() {
+    delete[] this->pc_table;
+    delete[] this->table;
+};
+
+// =====================================================================
+correlation_entry_t *correlation_prefetcher_t::find(uint64_t pc, uint64_t line) {
+    uint64_t key = pc ^ (line * 0x9e3779b97f4a7c15ULL);
+    return &this->table[prefetch_hash(key, 4 * this->table_size)];
+};
+
+// =====================================================================
+/// Learn "last miss line of this PC -> this line" (MRU first), then
+/// prefetch the successors of this line, following the most recent
+/// successor chain while the degree allows
+uint32_t correlation_prefetcher_t::access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch) {
+    if (!is_trigger) {
+        return 0;
+    }
+
+    uint64_t line = address / this->line_size;
+    correlation_pc_t *pc_entry = &this->pc_table[prefetch_hash(pc, this->table_size)];
+
+    if (pc_entry->pc == pc && pc_entry->last_line != line) {
+        uint64_t key = pc ^ pc_entry->last_line;
+        correlation_entry_t *entry = this->find(pc, pc_entry->last_line);
+        if (entry->key != key) {
+            entry->key = key;
+            for (uint32_t w = 0; w < PREFETCH_CORRELATION_WAYS; w++) {
+                entry->successor[w] = PREFETCH_NONE;
+            }
+        }
+        if (entry->successor[0] != line) {
+            for (uint32_t w = PREFETCH_CORRELATION_WAYS - 1; w > 0; w--) {
+                entry->successor[w] = (entry->successor[w - 1] == line) ? entry->successor[w] : entry->successor[w - 1];
+            }
+            entry->successor[0] = line;
+        }
+    }
+    pc_entry->pc = pc;
+    pc_entry->last_line = line;
+
+    uint32_t total = 0;
+    uint64_t current = line;
+    for (uint32_t depth = 0; depth < this->degree && total < this->degree; depth++) {
+        correlation_entry_t *entry = this->find(pc, current);
+        if (entry->key != (pc ^ current) || entry->successor[0] == PREFETCH_NONE) {
+            break;
+        }
+        for (uint32_t w = 0; w < PREFETCH_CORRELATION_WAYS && entry->successor[w] != PREFETCH_NONE; w++) {
+            total = this->add_prefetch(prefetch, total, entry->successor[w] * this->line_size);
+        }
+        current = entry->successor[0];
+    }
+    return total;
+};
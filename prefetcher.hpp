@@ -0,0 +1,158 @@
+// ============================================================================
+// ============================================================================
+/// Hardware prefetchers.
+/// Every prefetcher sees the demand stream (PC = opcode_address, data
+/// address) through access() and returns the line addresses to prefetch.
+/// is_trigger tells a miss, or the first use of a prefetched line, apart
+/// from an ordinary hit; stride trains on every access, the others only
+/// on triggers. The per-PC tables are direct mapped and indexed by a hash
+/// of the PC, with the PC kept as tag.
+#define PREFETCH_MAX_DEGREE 16
+#define PREFETCH_GHB_HISTORY 16
+#define PREFETCH_STREAM_WINDOW 16       /// Lines around a stream head
+#define PREFETCH_CORRELATION_WAYS 2     /// Successors kept per (PC, line)
+#define PREFETCH_NONE UINT64_MAX
+
+// ============================================================================
+enum prefetcher_type_t {
+    PREFETCHER_STRIDE,
+    PREFETCHER_STREAM,
+    PREFETCHER_GHB,
+    PREFETCHER_CORRELATION,
+    PREFETCHER_TOTAL
+};
+
+// ============================================================================
+static inline uint32_t prefetch_hash(uint64_t value, uint32_t table_size) {
+    value ^= value >> 17;
+    value *= 0xed5ad4bbULL;
+    value ^= value >> 11;
+    return (uint32_t)value & (table_size - 1);
+};
+
+// ============================================================================
+class prefetcher_t {
+    protected:
+        uint32_t line_size;
+        uint32_t degree;
+        uint32_t table_size;
+
+        /// Append a prefetch (line aligned, without repeating the last one)
+        uint32_t add_prefetch(uint64_t *prefetch, uint32_t total, uint64_t address) {
+            uint64_t line_address = address & ~(uint64_t)(this->line_size - 1);
+            if (total < this->degree && (total == 0 || prefetch[total - 1] != line_address)) {
+                prefetch[total++] = line_address;
+            }
+            return total;
+        };
+
+    public:
+        prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t entries) {
+            this->line_size = line_bytes;
+            this->degree = prefetch_degree;
+            this->table_size = entries;
+        };
+        virtual ~prefetcher_t() {};
+
+        virtual const char *get_name() = 0;
+        /// Returns how many addresses were written to prefetch (<= degree)
+        virtual uint32_t access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch) = 0;
+
+        static prefetcher_t *create(prefetcher_type_t type, config_t *config);
+        static bool find_type(const char *name, prefetcher_type_t *type);
+};
+
+// ============================================================================
+/// Reference Prediction Table: per-PC last address and stride
+struct stride_entry_t {
+    uint64_t pc;
+    uint64_t last_address;
+    int64_t stride;
+    uint32_t confidence;
+};
+
+class stride_prefetcher_t : public prefetcher_t {
+    private:
+        stride_entry_t *table;
+
+    public:
+        stride_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t entries);
+        ~stride_prefetcher_t();
+        const char *get_name() { return "stride"; };
+        uint32_t access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch);
+};
+
+// ============================================================================
+/// Stream buffers: ascending/descending miss streams, PC agnostic
+struct stream_entry_t {
+    uint64_t last_line;
+    int64_t direction;
+    uint32_t confidence;
+    uint64_t last_use;
+};
+
+class stream_prefetcher_t : public prefetcher_t {
+    private:
+        stream_entry_t *stream;
+        uint32_t total_streams;
+        uint64_t use_stamp;
+
+    public:
+        stream_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t streams);
+        ~stream_prefetcher_t();
+        const char *get_name() { return "stream"; };
+        uint32_t access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch);
+};
+
+// ============================================================================
+/// Global History Buffer, PC localized delta correlation (PC/DC)
+struct ghb_entry_t {
+    uint64_t line;
+    uint64_t sequence;          /// Position in the history, to detect overwrites
+    uint64_t previous;          /// Previous miss of the same PC (sequence)
+};
+
+struct ghb_index_t {
+    uint64_t pc;
+    uint64_t last;              /// Last miss of the PC (sequence)
+};
+
+class ghb_prefetcher_t : public prefetcher_t {
+    private:
+        ghb_entry_t *history;
+        uint32_t history_size;
+        uint64_t next_sequence;
+        ghb_index_t *index;
+
+    public:
+        ghb_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t entries, uint32_t history_entries);
+        ~ghb_prefetcher_t();
+        const char *get_name() { return "ghb"; };
+        uint32_t access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch);
+};
+
+// ============================================================================
+/// Per-PC Markov correlation: (PC, miss line) -> next miss lines of that PC
+struct correlation_pc_t {
+    uint64_t pc;
+    uint64_t last_line;
+};
+
+struct correlation_entry_t {
+    uint64_t key;               /// PC ^ line, PREFETCH_NONE when empty
+    uint64_t successor[PREFETCH_CORRELATION_WAYS];
+};
+
+class correlation_prefetcher_t : public prefetcher_t {
+    private:
+        correlation_pc_t *pc_table;
+        correlation_entry_t *table;     /// 4 * table_size entries
+
+        correlation_entry_t *find(uint64_t pc, uint64_t line);
+
+    public:
+        correlation_prefetcher_t(uint32_t line_bytes, uint32_t prefetch_degree, uint32_t entries);
+        ~correlation_prefetcher_t();
+        const char *get_name() { return "correlation"; };
+        uint32_t access(uint64_t pc, uint64_t address, bool is_trigger, uint64_t *prefetch);
+};
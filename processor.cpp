@@ -2,29 +2,182 @@
 
 // =====================================================================
 processor_t::processor_t() {
+	this->clock_engine = &processor_t::clock_generic;
+	this->engine_name = "generic";
+	this->busy_until_cycle = 0;
+	this->data_cache = new cache_t;
 
+	this->stat_instructions = 0;
+	this->stat_fetch_groups = 0;
+	this->stat_stall_cycles = 0;
 };
 
 // =====================================================================
+processor_t::~processor_t() {
+	delete this->data_cache;
+};
+
+// =====================================================================
+/// Also called by a forked child after loading its own configuration
 void processor_t::allocate() {
+	config_t *config = orcs_engine.config;
+
+	this->fetch_width = config->fetch_width;
+	for (uint32_t i = 0; i < INSTRUCTION_OPERATION_TOTAL; i++) {
+		this->latency[i] = config->latency[i];
+	}
+	this->l1d_hit_latency = config->l1d_hit_latency;
 
+	/// Keep the warm contents when the geometry did not change
+	uint32_t l1d_sets = config->get_l1d_sets();
+	if (!this->data_cache->has_geometry(l1d_sets, config->l1d_associativity, config->l1d_line_size)) {
+		this->data_cache->allocate(l1d_sets, config->l1d_associativity, config->l1d_line_size);
+	}
+
+	/// Pick the specialized engine for the production configurations
+	struct processor_engine_t {
+		const char *name;
+		uint32_t fetch_width;
+		uint32_t l1d_sets;
+		uint32_t l1d_associativity;
+		uint32_t l1d_line_size;
+		void (processor_t::*clock_engine)();
+	};
+	static const processor_engine_t production_engine[] = {
+		#define PRODUCTION_CONFIG(NAME, FETCH_WIDTH, L1D_SETS, L1D_ASSOCIATIVITY, L1D_LINE_SIZE) \
+			{#NAME, FETCH_WIDTH, L1D_SETS, L1D_ASSOCIATIVITY, L1D_LINE_SIZE, \
+			&processor_t::clock_fixed<FETCH_WIDTH, L1D_SETS, L1D_ASSOCIATIVITY, L1D_LINE_SIZE>},
+		#include "production_configs.def"
+		#undef PRODUCTION_CONFIG
+	};
+
+	this->clock_engine = &processor_t::clock_generic;
+	this->engine_name = "generic";
+	for (uint32_t i = 0; i < sizeof(production_engine) / sizeof(production_engine[0]); i++) {
+		if (production_engine[i].fetch_width == this->fetch_width &&
+			production_engine[i].l1d_sets == l1d_sets &&
+			production_engine[i].l1d_associativity == config->l1d_associativity &&
+			production_engine[i].l1d_line_size == config->l1d_line_size) {
+			this->clock_engine = production_engine[i].clock_engine;
+			this->engine_name = production_engine[i].name;
+			break;
+		}
+	}
+	DEBUG_PRINTF("Processor engine: %s\n", this->engine_name);
 };
 
 // =====================================================================
-void processor_t::clock() {
+/// Misses go to the main memory. Loads wait for the answer, stores are
+/// posted and only take the cache latency.
+inline __attribute__((always_inline))
+uint32_t processor_t::data_access(uint64_t address, bool is_write, uint32_t sets, uint32_t ways, uint32_t line_bytes) {
+	if (this->data_cache->access_geometry(address, sets, ways, line_bytes)) {
+		return this->l1d_hit_latency;
+	}
+
+	uint64_t miss_cycle = orcs_engine.global_cycle + this->l1d_hit_latency;
+	if (is_write) {
+		orcs_engine.memory->request(address, MEMORY_OPERATION_WRITE, miss_cycle);
+		return this->l1d_hit_latency;
+	}
+	return orcs_engine.memory->request(address, MEMORY_OPERATION_READ, miss_cycle) - orcs_engine.global_cycle;
+};
 
-	/// Get the next instruction from the trace
-	opcode_package_t new_instruction;
-	if (!orcs_engine.trace_reader->trace_fetch(&new_instruction)) {
-		/// If EOF
-		orcs_engine.simulator_alive = false;
+// =====================================================================
+/// HMC operations bypass the cache and execute near memory, the
+/// instruction waits for the answer
+inline uint32_t processor_t::hmc_access(opcode_package_t *instruction) {
+	memory_operation_t operation = MEMORY_OPERATION_HMC_ROA;
+	if (instruction->opcode_operation == INSTRUCTION_OPERATION_HMC_ROWA) {
+		operation = MEMORY_OPERATION_HMC_ROWA;
 	}
 
+	uint64_t address = instruction->is_read ? instruction->read_address : instruction->write_address;
+	return orcs_engine.memory->request(address, operation, orcs_engine.global_cycle) - orcs_engine.global_cycle;
+};
+
+// =====================================================================
+/// One fetch group per cycle: up to width instructions, ending at a
+/// branch. The group takes the latency of its slowest instruction.
+inline __attribute__((always_inline))
+void processor_t::clock_body(uint32_t width, uint32_t sets, uint32_t ways, uint32_t line_bytes) {
+	if (orcs_engine.global_cycle < this->busy_until_cycle) {
+		this->stat_stall_cycles++;
+		return;
+	}
+
+	uint32_t group_latency = 1;
+	for (uint32_t i = 0; i < width; i++) {
+		/// Get the next instruction from the trace
+		opcode_package_t new_instruction;
+		if (!orcs_engine.trace_reader->trace_fetch(&new_instruction)) {
+			/// If EOF
+			orcs_engine.simulator_alive = false;
+			break;
+		}
+		this->stat_instructions++;
+
+		uint32_t instruction_latency = this->latency[new_instruction.opcode_operation];
+		if (new_instruction.opcode_operation == INSTRUCTION_OPERATION_HMC_ROA ||
+			new_instruction.opcode_operation == INSTRUCTION_OPERATION_HMC_ROWA) {
+			instruction_latency += this->hmc_access(&new_instruction);
+		}
+		else {
+			if (new_instruction.is_read) {
+				instruction_latency += this->data_access(new_instruction.read_address, false, sets, ways, line_bytes);
+			}
+			if (new_instruction.is_read2) {
+				instruction_latency += this->data_access(new_instruction.read2_address, false, sets, ways, line_bytes);
+			}
+			if (new_instruction.is_write) {
+				instruction_latency += this->data_access(new_instruction.write_address, true, sets, ways, line_bytes);
+			}
+		}
+
+		if (instruction_latency > group_latency) {
+			group_latency = instruction_latency;
+		}
+		if (new_instruction.opcode_operation == INSTRUCTION_OPERATION_BRANCH) {
+			break;
+		}
+	}
+
+	this->stat_fetch_groups++;
+	this->busy_until_cycle = orcs_engine.global_cycle + group_latency;
+};
+
+// =====================================================================
+void processor_t::clock_generic() {
+	this->clock_body(this->fetch_width, this->data_cache->get_total_sets(),
+					this->data_cache->get_associativity(), this->data_cache->get_line_size());
+};
+
+// =====================================================================
+template <uint32_t FETCH_WIDTH, uint32_t L1D_SETS, uint32_t L1D_ASSOCIATIVITY, uint32_t L1D_LINE_SIZE>
+void processor_t::clock_fixed() {
+	this->clock_body(FETCH_WIDTH, L1D_SETS, L1D_ASSOCIATIVITY, L1D_LINE_SIZE);
 };
 
 // =====================================================================
 void processor_t::statistics() {
 	ORCS_PRINTF("######################################################\n");
 	ORCS_PRINTF("processor_t\n");
+	ORCS_PRINTF("engine:%s\n", this->engine_name);
+	ORCS_PRINTF("instructions:%" PRIu64 "\n", this->stat_instructions);
+	ORCS_PRINTF("fetch_groups:%" PRIu64 "\n", this->stat_fetch_groups);
+	ORCS_PRINTF("stall_cycles:%" PRIu64 "\n", this->stat_stall_cycles);
+	ORCS_PRINTF("IPC:%.4f\n", (double)this->stat_instructions / (orcs_engine.get_global_cycle() ? orcs_engine.get_global_cycle() : 1));
+	this->data_cache->statistics("l1d");
+
+};
+
+// =====================================================================
+void processor_t::checkpoint(checkpoint_t *checkpoint) {
+	checkpoint->section("PROC");
+	checkpoint->transfer(&this->busy_until_cycle);
+	checkpoint->transfer(&this->stat_instructions);
+	checkpoint->transfer(&this->stat_fetch_groups);
+	checkpoint->transfer(&this->stat_stall_cycles);
 
+	this->data_cache->checkpoint(checkpoint);
 };
@@ -2,15 +2,43 @@
 // ============================================================================
 class processor_t {
     private:    
-    
-    
+        /// Clock engine selected at allocate(): specialized or generic
+        void (processor_t::*clock_engine)();
+        const char *engine_name;
+
+        /// Parameters copied from the configuration
+        uint32_t fetch_width;
+        uint32_t latency[INSTRUCTION_OPERATION_TOTAL];
+        uint32_t l1d_hit_latency;
+
+        /// In-order issue: the next fetch group waits for the current one
+        uint64_t busy_until_cycle;
+
+        cache_t *data_cache;
+
+        inline uint32_t data_access(uint64_t address, bool is_write, uint32_t sets, uint32_t ways, uint32_t line_bytes);
+        inline uint32_t hmc_access(opcode_package_t *instruction);
+        inline void clock_body(uint32_t width, uint32_t sets, uint32_t ways, uint32_t line_bytes);
+        void clock_generic();
+        template <uint32_t FETCH_WIDTH, uint32_t L1D_SETS, uint32_t L1D_ASSOCIATIVITY, uint32_t L1D_LINE_SIZE>
+        void clock_fixed();
+
     public:
+        /// Statistics
+        uint64_t stat_instructions;
+        uint64_t stat_fetch_groups;
+        uint64_t stat_stall_cycles;
 
 		// ====================================================================
 		/// Methods
 		// ====================================================================
 		processor_t();
+		~processor_t();
 	    void allocate();
-	    void clock();
 	    void statistics();
+	    void checkpoint(checkpoint_t *checkpoint);
+
+	    void clock() {
+	        (this->*clock_engine)();
+	    };
 };
@@ -5,7 +5,17 @@ orcs_engine_t orcs_engine;
 // =============================================================================
 static void display_use() {
     ORCS_PRINTF("**** OrCS - Ordinary Computer Simulator ****\n\n");
-    ORCS_PRINTF("Please provide -t <trace_file_basename>");
+    ORCS_PRINTF("Please provide -t <trace_file_basename>\n");
+    ORCS_PRINTF("Optional -c <config_file> (key = value parameters, see config.hpp)\n");
+    ORCS_PRINTF("Optional -p <stats_page_file> (e.g. /dev/shm/orcs.<name>.stats, read by orcs-top)\n");
+    ORCS_PRINTF("Optional -r <checkpoint_file> to restore the simulation state\n");
+    ORCS_PRINTF("Optional -w <warmup_cycles> before saving -k <checkpoint_file>\n");
+    ORCS_PRINTF("Optional -b <interval_instructions> to write basic-block vectors and SimPoints (-o <output_basename>)\n");
+    ORCS_PRINTF("Optional -x <regions_file> -i <region_index> to simulate only one SimPoint region\n");
+    ORCS_PRINTF("Optional -e <prefetchers> (stride,stream,ghb,correlation or all) to evaluate prefetchers on shadow caches\n");
+    ORCS_PRINTF("         each one may override its parameters, e.g. -e stride,stride:degree=8:table_size=64\n");
+    ORCS_PRINTF("Optional -f <config_file> (repeatable) to fork one simulation per configuration after the warm-up\n");
+    ORCS_PRINTF("Optional -B with -f to decode the trace once and broadcast it to the forked configurations\n");
 };
 
 // =============================================================================
@@ -15,13 +25,25 @@ static void process_argv(int argc, char **argv) {
     static struct option long_options[] = {
         {"help",        no_argument, 0, 'h'},
         {"trace",       required_argument, 0, 't'},
+        {"config",      required_argument, 0, 'c'},
+        {"stats_page",  required_argument, 0, 'p'},
+        {"restore",     required_argument, 0, 'r'},
+        {"checkpoint",  required_argument, 0, 'k'},
+        {"warmup",      required_argument, 0, 'w'},
+        {"fork_config", required_argument, 0, 'f'},
+        {"bbv",         required_argument, 0, 'b'},
+        {"bbv_output",  required_argument, 0, 'o'},
+        {"region_file", required_argument, 0, 'x'},
+        {"region_index", required_argument, 0, 'i'},
+        {"prefetch_eval", required_argument, 0, 'e'},
+        {"broadcast",   no_argument, 0, 'B'},
         {NULL,          0, NULL, 0}
     };
 
     // Count number of traces
     int opt;
     int option_index = 0;
-    while ((opt = getopt_long_only(argc, argv, "h:t:",
+    while ((opt = getopt_long_only(argc, argv, "h:t:c:p:r:k:w:f:b:o:x:i:e:B",
                  long_options, &option_index)) != -1) {
         switch (opt) {
         case 0:
@@ -38,6 +60,56 @@ static void process_argv(int argc, char **argv) {
         case 't':
             orcs_engine.arg_trace_file_name = optarg;
             break;
+
+        case 'c':
+            orcs_engine.arg_config_file_name = optarg;
+            break;
+
+        case 'p':
+            orcs_engine.arg_stats_page_file_name = optarg;
+            break;
+
+        case 'r':
+            orcs_engine.arg_restore_file_name = optarg;
+            break;
+
+        case 'k':
+            orcs_engine.arg_checkpoint_file_name = optarg;
+            break;
+
+        case 'w':
+            orcs_engine.arg_warmup_cycles = strtoull(optarg, NULL, 10);
+            break;
+
+        case 'f':
+            ERROR_ASSERT_PRINTF(orcs_engine.arg_total_fork_configs < MAX_FORK_CONFIGS, "Too many configurations to fork (max %u).\n", MAX_FORK_CONFIGS);
+            orcs_engine.arg_fork_config[orcs_engine.arg_total_fork_configs++] = optarg;
+            break;
+
+        case 'b':
+            orcs_engine.arg_bbv_interval = strtoull(optarg, NULL, 10);
+            break;
+
+        case 'o':
+            orcs_engine.arg_bbv_output_name = optarg;
+            break;
+
+        case 'x':
+            orcs_engine.arg_region_file_name = optarg;
+            break;
+
+        case 'i':
+            orcs_engine.arg_region_index = strtoul(optarg, NULL, 10);
+            break;
+
+        case 'e':
+            orcs_engine.arg_prefetch_eval = optarg;
+            break;
+
+        case 'B':
+            orcs_engine.arg_broadcast = true;
+            break;
+
         case '?':
             break;
 
@@ -62,6 +134,20 @@ static void process_argv(int argc, char **argv) {
 };
 
 
+// =============================================================================
+/// Clock all the components until the end of the trace or the end_cycle
+static void simulate(uint64_t end_cycle) {
+    while (orcs_engine.simulator_alive && orcs_engine.global_cycle < end_cycle) {
+        orcs_engine.processor->clock();
+        orcs_engine.memory->clock();
+        orcs_engine.global_cycle++;
+
+        if (orcs_engine.global_cycle >= orcs_engine.stats_page->next_update_cycle) {
+            orcs_engine.stats_page->update();
+        }
+    }
+};
+
 // =============================================================================
 int main(int argc, char **argv) {
     process_argv(argc, argv);
@@ -70,19 +156,84 @@ int main(int argc, char **argv) {
     orcs_engine.allocate();
     orcs_engine.trace_reader->allocate(orcs_engine.arg_trace_file_name);
     orcs_engine.processor->allocate();
+    orcs_engine.memory->allocate();
+    orcs_engine.stats_page->allocate(orcs_engine.arg_stats_page_file_name);
+    orcs_engine.stats_page->add_counter("processor.instructions", &orcs_engine.processor->stat_instructions);
+    orcs_engine.stats_page->add_counter("processor.stall_cycles", &orcs_engine.processor->stat_stall_cycles);
+    orcs_engine.stats_page->add_counter("memory.row_hits", &orcs_engine.memory->stat_row_hits);
+    orcs_engine.stats_page->add_counter("memory.row_conflicts", &orcs_engine.memory->stat_row_conflicts);
 
     orcs_engine.simulator_alive = true;
 
+    /// Basic-block vectors and SimPoints only, nothing is simulated
+    if (orcs_engine.arg_bbv_interval > 0) {
+        const char *output_name = orcs_engine.arg_bbv_output_name;
+        if (output_name == NULL) {
+            output_name = orcs_engine.arg_trace_file_name;
+        }
+        bbv_t bbv;
+        bbv.allocate(orcs_engine.arg_bbv_interval, output_name);
+        bbv.run();
+        bbv.simpoints(output_name);
+        bbv.statistics();
+        orcs_engine.allocator->statistics();
+        return(EXIT_SUCCESS);
+    }
 
-    /// Start CLOCK for all the components
-    while (orcs_engine.simulator_alive) {
-        orcs_engine.processor->clock();
-        orcs_engine.global_cycle++;
+    if (orcs_engine.arg_restore_file_name != NULL) {
+        orcs_engine.checkpoint_restore(orcs_engine.arg_restore_file_name);
     }
 
+    /// Fast-forward to a SimPoint region and stop at its end
+    if (orcs_engine.arg_region_file_name != NULL) {
+        uint64_t region_start, region_length;
+        bbv_t::read_region(orcs_engine.arg_region_file_name, orcs_engine.arg_region_index, &region_start, &region_length);
+        uint64_t fetched = orcs_engine.trace_reader->get_fetch_instructions();
+        ERROR_ASSERT_PRINTF(region_start >= fetched, "Region starts at instruction %" PRIu64 ", already at %" PRIu64 ".\n", region_start, fetched);
+
+        orcs_engine.trace_reader->trace_skip(region_start - fetched);
+        orcs_engine.trace_reader->set_fetch_limit(region_start + region_length);
+        ORCS_PRINTF("Region %u: instructions [%" PRIu64 ", %" PRIu64 ")\n", orcs_engine.arg_region_index, region_start, region_start + region_length);
+    }
+
+    /// Prefetcher evaluation only, over the (restored / region) trace
+    if (orcs_engine.arg_prefetch_eval != NULL) {
+        prefetch_evaluator_t prefetch_evaluator;
+        prefetch_evaluator.allocate(orcs_engine.arg_prefetch_eval);
+        prefetch_evaluator.run();
+        orcs_engine.config->statistics();
+        orcs_engine.trace_reader->statistics();
+        prefetch_evaluator.statistics();
+        orcs_engine.allocator->statistics();
+        return(EXIT_SUCCESS);
+    }
+
+    /// Warm-up once, then save and/or fan-out the warm state
+    if (orcs_engine.arg_warmup_cycles > 0) {
+        simulate(orcs_engine.global_cycle + orcs_engine.arg_warmup_cycles);
+        ORCS_PRINTF("End of Warm-up\n");
+    }
+    if (orcs_engine.arg_checkpoint_file_name != NULL) {
+        orcs_engine.checkpoint_save(orcs_engine.arg_checkpoint_file_name);
+    }
+    ERROR_ASSERT_PRINTF(!orcs_engine.arg_broadcast || orcs_engine.arg_total_fork_configs > 0, "Broadcast (-B) needs at least one -f configuration.\n");
+    if (orcs_engine.arg_total_fork_configs > 0 && !orcs_engine.fork_configs()) {
+        return(EXIT_SUCCESS);
+    }
+
+    /// Start CLOCK for all the components
+    simulate(UINT64_MAX);
+    orcs_engine.stats_page->finish();
+
 	ORCS_PRINTF("End of Simulation\n")
+	orcs_engine.config->statistics();
 	orcs_engine.trace_reader->statistics();
     orcs_engine.processor->statistics();
+    orcs_engine.memory->statistics();
+    orcs_engine.allocator->statistics();
+    if (orcs_engine.broadcast != NULL) {
+        orcs_engine.broadcast->statistics();
+    }
 
     return(EXIT_SUCCESS);
 };
@@ -8,12 +8,22 @@
 #include <getopt.h>     /* for getopt_long; POSIX standard getopt is in unistd.h */
 #include <inttypes.h>   /* for uint32_t */
 #include <zlib.h>
+#include <fcntl.h>      /* for open */
+#include <sys/mman.h>   /* for mmap */
+#include <sys/stat.h>   /* for fstat */
+#include <sys/time.h>   /* for gettimeofday */
+#include <sys/wait.h>   /* for waitpid */
+#include <sys/resource.h>   /* for getrusage */
+#include <sched.h>      /* for sched_yield */
+#include <sys/prctl.h>  /* for prctl */
+#include <signal.h>     /* for SIGKILL */
 
 /// C++ Includes
 #include <cstdio>
 #include <cstdlib>
 #include <string>
 #include <cstring>
+#include <new>
 
 
 // ============================================================================
@@ -23,6 +33,18 @@ class orcs_engine_t;
 class trace_reader_t;
 class opcode_package_t;
 class processor_t;
+class stats_page_t;
+class checkpoint_t;
+class config_t;
+class cache_t;
+class bbv_t;
+class memory_controller_t;
+class prefetcher_t;
+class prefetch_evaluator_t;
+class allocator_t;
+class arena_t;
+class string_table_t;
+class trace_broadcast_t;
 
 // ============================================================================
 /// Global SINUCA_ENGINE instantiation
@@ -125,11 +147,22 @@ enum branch_t {
 /// Our Includes
 #include "./simulator.hpp"
 #include "./orcs_engine.hpp"
+#include "./checkpoint.hpp"
+#include "./allocator.hpp"
 #include "./trace_reader.hpp"
+#include "./trace_broadcast.hpp"
 #include "./opcode_package.hpp"
+#include "./config.hpp"
+#include "./cache.hpp"
 
+#include "./memory_controller.hpp"
 #include "./processor.hpp"
 
+#include "./stats_page.hpp"
+#include "./bbv.hpp"
+#include "./prefetcher.hpp"
+#include "./prefetch_eval.hpp"
+
 
 
 #endif  // _ORCS_ORCS_HPP_
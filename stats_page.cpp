@@ -0,0 +1,151 @@
+#include "simulator.hpp"
+
+// =====================================================================
+static uint64_t stats_page_time_us() {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_usec;
+};
+
+// =====================================================================
+stats_page_t::stats_page_t() {
+    this->page_file_name[0] = '\0';
+    this->file_descriptor = -1;
+    this->page = NULL;
+    this->total_counters = 0;
+    this->update_interval = STATS_PAGE_UPDATE_CYCLES;
+    this->last_update_time_us = 0;
+    this->last_update_instructions = 0;
+    this->next_update_cycle = UINT64_MAX;
+};
+
+// =====================================================================
+stats_page_t::~stats_page_t() {
+    if (this->page != NULL) {
+        munmap(this->page, sizeof(stats_page_data_t));
+        close(this->file_descriptor);
+    }
+};
+
+// =====================================================================
+/// Without a file name the page stays disabled and update() is never called
+void stats_page_t::allocate(char *page_file_name) {
+    if (page_file_name == NULL) {
+        return;
+    }
+    snprintf(this->page_file_name, sizeof(this->page_file_name), "%s", page_file_name);
+
+    /// No O_TRUNC: an orcs-top still mapping an old page would get SIGBUS,
+    /// the page is resized and cleared in place instead
+    this->file_descriptor = open(page_file_name, O_RDWR | O_CREAT, 0644);
+    ERROR_ASSERT_PRINTF(this->file_descriptor >= 0, "Could not open the stats page.\n%s\n", page_file_name);
+    ERROR_ASSERT_PRINTF(ftruncate(this->file_descriptor, sizeof(stats_page_data_t)) == 0, "Could not resize the stats page.\n%s\n", page_file_name);
+
+    void *map = mmap(NULL, sizeof(stats_page_data_t), PROT_READ | PROT_WRITE, MAP_SHARED, this->file_descriptor, 0);
+    ERROR_ASSERT_PRINTF(map != MAP_FAILED, "Could not map the stats page.\n%s\n", page_file_name);
+    this->page = (stats_page_data_t*)map;
+
+    memset(this->page, 0, sizeof(stats_page_data_t));
+    this->page->version = STATS_PAGE_VERSION;
+    this->page->pid = getpid();
+    if (orcs_engine.arg_trace_file_name != NULL) {
+        strncpy(this->page->trace_file_name, orcs_engine.arg_trace_file_name, STATS_PAGE_NAME_SIZE - 1);
+    }
+    this->page->simulator_alive = true;
+    this->page->start_time_us = stats_page_time_us();
+    this->last_update_time_us = this->page->start_time_us;
+
+    /// The magic goes last, readers ignore the page until it is valid
+    __atomic_store_n(&this->page->magic, STATS_PAGE_MAGIC, __ATOMIC_RELEASE);
+
+    this->next_update_cycle = orcs_engine.get_global_cycle() + this->update_interval;
+};
+
+// =====================================================================
+void stats_page_t::add_counter(const char *name, const uint64_t *source) {
+    if (this->page == NULL) {
+        return;
+    }
+    ERROR_ASSERT_PRINTF(this->total_counters < STATS_PAGE_MAX_COUNTERS, "Too many counters on the stats page.\n");
+
+    strncpy(this->page->counter[this->total_counters].name, name, STATS_PAGE_COUNTER_NAME_SIZE - 1);
+    this->counter_source[this->total_counters] = source;
+    this->total_counters++;
+    this->page->total_counters = this->total_counters;
+};
+
+// =====================================================================
+void stats_page_t::update() {
+    if (this->page == NULL) {
+        return;
+    }
+
+    uint64_t now_us = stats_page_time_us();
+    uint64_t elapsed_us = now_us - this->last_update_time_us;
+    uint64_t instructions = orcs_engine.trace_reader->get_fetch_instructions();
+
+    /// Seqlock write: readers retry while the sequence is odd or changed
+    uint64_t sequence = this->page->sequence;
+    __atomic_store_n(&this->page->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    this->page->update_time_us = now_us;
+    this->page->global_cycle = orcs_engine.get_global_cycle();
+    this->page->fetch_instructions = instructions;
+    this->page->current_bbl = orcs_engine.trace_reader->get_current_bbl();
+    this->page->total_bbls = orcs_engine.trace_reader->get_binary_total_bbls();
+    if (elapsed_us > 0) {
+        this->page->mips = (double)(instructions - this->last_update_instructions) / elapsed_us;
+    }
+    for (uint32_t i = 0; i < this->total_counters; i++) {
+        this->page->counter[i].value = *this->counter_source[i];
+    }
+
+    __atomic_store_n(&this->page->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    /// Adapt the interval, so the time is only read a few times per second
+    if (elapsed_us < STATS_PAGE_UPDATE_US / 2 && this->update_interval < (UINT64_MAX >> 2)) {
+        this->update_interval *= 2;
+    }
+    else if (elapsed_us > STATS_PAGE_UPDATE_US * 2 && this->update_interval > 1) {
+        this->update_interval /= 2;
+    }
+
+    this->last_update_time_us = now_us;
+    this->last_update_instructions = instructions;
+    this->next_update_cycle = orcs_engine.get_global_cycle() + this->update_interval;
+};
+
+// =====================================================================
+void stats_page_t::finish() {
+    if (this->page == NULL) {
+        return;
+    }
+    this->update();
+    this->page->simulator_alive = false;
+    this->next_update_cycle = UINT64_MAX;
+    msync(this->page, sizeof(stats_page_data_t), MS_ASYNC);
+};
+
+// =====================================================================
+/// A forked child publishes on its own page: <page_file_name>.<child_id>
+void stats_page_t::fork_child(uint32_t child_id) {
+    if (this->page == NULL) {
+        return;
+    }
+
+    /// Leave the parent page (still shared with the parent) untouched
+    stats_page_counter_t counter[STATS_PAGE_MAX_COUNTERS];
+    memcpy(counter, this->page->counter, sizeof(counter));
+    munmap(this->page, sizeof(stats_page_data_t));
+    close(this->file_descriptor);
+    this->page = NULL;
+
+    char child_file_name[TRACE_LINE_SIZE + 16];
+    snprintf(child_file_name, sizeof(child_file_name), "%s.%u", this->page_file_name, child_id);
+    this->allocate(child_file_name);
+
+    /// Same counters, same sources
+    memcpy(this->page->counter, counter, sizeof(counter));
+    this->page->total_counters = this->total_counters;
+};
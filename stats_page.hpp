@@ -0,0 +1,108 @@
+// ============================================================================
+// ============================================================================
+/// Shared statistics page layout.
+/// Any change in the layout below must increase STATS_PAGE_VERSION,
+/// so orcs-top refuses to read pages from a different simulator build.
+#define STATS_PAGE_MAGIC 0x4547415053435230ULL     /// "0RCSPAGE"
+#define STATS_PAGE_VERSION 1
+#define STATS_PAGE_NAME_SIZE 256
+#define STATS_PAGE_COUNTER_NAME_SIZE 32
+#define STATS_PAGE_MAX_COUNTERS 16
+
+/// Cycles between two updates (adapted at runtime to ~STATS_PAGE_UPDATE_US)
+#define STATS_PAGE_UPDATE_CYCLES 1048576
+#define STATS_PAGE_UPDATE_US 250000
+
+/// Reader attempts before giving up on a page stuck in an update
+/// (a writer killed between the two sequence increments)
+#define STATS_PAGE_READ_RETRIES 1024
+
+struct stats_page_counter_t {
+    char name[STATS_PAGE_COUNTER_NAME_SIZE];
+    uint64_t value;
+};
+
+struct stats_page_data_t {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t pid;
+
+    /// Seqlock: odd while the writer is updating the fields below
+    uint64_t sequence;
+
+    char trace_file_name[STATS_PAGE_NAME_SIZE];
+    uint32_t simulator_alive;
+    uint32_t total_counters;
+
+    uint64_t start_time_us;
+    uint64_t update_time_us;
+
+    uint64_t global_cycle;
+    uint64_t fetch_instructions;
+    uint32_t current_bbl;
+    uint32_t total_bbls;
+    double mips;
+
+    stats_page_counter_t counter[STATS_PAGE_MAX_COUNTERS];
+};
+
+// ============================================================================
+/// Consistent copy of a page written by another process.
+/// Returns FAIL if the page is not a valid OrCS page of this version.
+/// is_consistent is false when no consistent copy was obtained within
+/// STATS_PAGE_READ_RETRIES attempts; copy then holds the last attempt.
+static inline bool stats_page_read(const stats_page_data_t *page, stats_page_data_t *copy, bool *is_consistent) {
+    if (page->magic != STATS_PAGE_MAGIC || page->version != STATS_PAGE_VERSION) {
+        return FAIL;
+    }
+
+    *is_consistent = false;
+    for (uint32_t i = 0; i < STATS_PAGE_READ_RETRIES; i++) {
+        uint64_t begin = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+        memcpy(copy, page, sizeof(stats_page_data_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (!(begin & 1) && __atomic_load_n(&page->sequence, __ATOMIC_RELAXED) == begin) {
+            *is_consistent = true;
+            break;
+        }
+        sched_yield();
+    }
+    /// The page may have been reset by a new simulator while copying
+    if (copy->magic != STATS_PAGE_MAGIC || copy->version != STATS_PAGE_VERSION) {
+        return FAIL;
+    }
+    return OK;
+};
+
+// ============================================================================
+// ============================================================================
+class stats_page_t {
+    private:
+        char page_file_name[TRACE_LINE_SIZE];
+        int file_descriptor;
+        stats_page_data_t *page;
+
+        /// Registered counters (copied into the page at each update)
+        uint32_t total_counters;
+        const uint64_t *counter_source[STATS_PAGE_MAX_COUNTERS];
+
+        /// Control the update frequency
+        uint64_t update_interval;
+        uint64_t last_update_time_us;
+        uint64_t last_update_instructions;
+
+    public:
+        /// Next global cycle to update the page (UINT64_MAX when disabled)
+        uint64_t next_update_cycle;
+
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        stats_page_t();
+        ~stats_page_t();
+        void allocate(char *page_file_name);
+        void add_counter(const char *name, const uint64_t *source);
+        void update();
+        void finish();
+        void fork_child(uint32_t child_id);
+};
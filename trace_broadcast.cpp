@@ -0,0 +1,217 @@
+#include "simulator.hpp"
+
+// =====================================================================
+/// A child leaving for any reason (end of the trace or an error) must
+/// not hold the producer back
+static void trace_broadcast_exit() {
+    if (orcs_engine.broadcast != NULL) {
+        orcs_engine.broadcast->detach();
+    }
+};
+
+// =====================================================================
+static void trace_broadcast_wait(uint32_t *spin) {
+    if (++*spin >= BROADCAST_SPIN) {
+        *spin = 0;
+        sched_yield();
+    }
+};
+
+// =====================================================================
+trace_broadcast_t::trace_broadcast_t() {
+    this->ring = NULL;
+    this->batch = NULL;
+    this->map_size = 0;
+    this->ring_batches = 0;
+    this->total_consumers = 0;
+    this->producer_pid = 0;
+    for (uint32_t i = 0; i < MAX_FORK_CONFIGS; i++) {
+        this->consumer_pid[i] = 0;
+    }
+
+    this->consumer = BROADCAST_NO_CONSUMER;
+    this->next_batch = 0;
+    this->next_entry = 0;
+    this->current_batch = NULL;
+
+    this->stat_batches = 0;
+    this->stat_instructions = 0;
+    this->stat_full_waits = 0;
+    this->stat_empty_waits = 0;
+};
+
+// =====================================================================
+trace_broadcast_t::~trace_broadcast_t() {
+    if (this->ring != NULL) {
+        munmap(this->ring, this->map_size);
+    }
+};
+
+// =====================================================================
+/// Must be called before the fork, the children inherit the mapping
+void trace_broadcast_t::allocate(uint32_t batches, uint32_t consumers) {
+    ERROR_ASSERT_PRINTF(consumers > 0 && consumers <= MAX_FORK_CONFIGS, "Broadcast needs 1 to %u configurations.\n", MAX_FORK_CONFIGS);
+    this->ring_batches = batches;
+    this->total_consumers = consumers;
+    this->producer_pid = getpid();
+
+    this->map_size = sizeof(trace_broadcast_ring_t) + sizeof(trace_broadcast_batch_t) * batches;
+    void *map = mmap(NULL, this->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ERROR_ASSERT_PRINTF(map != MAP_FAILED, "Could not map the broadcast ring.\n");
+    this->ring = (trace_broadcast_ring_t*)map;
+    this->batch = (trace_broadcast_batch_t*)(this->ring + 1);
+
+    /// Zero filled: nothing produced, nothing consumed
+    for (uint32_t i = consumers; i < MAX_FORK_CONFIGS; i++) {
+        this->ring->consumed[i].value = BROADCAST_DETACHED;
+    }
+};
+
+// =====================================================================
+void trace_broadcast_t::attach(uint32_t consumer_index) {
+    this->consumer = consumer_index;
+    this->next_batch = 0;
+    this->next_entry = 0;
+    this->current_batch = NULL;
+    atexit(trace_broadcast_exit);
+
+    /// The producer may already be gone before the signal is armed
+    ERROR_ASSERT_PRINTF(prctl(PR_SET_PDEATHSIG, SIGKILL) == 0, "Could not follow the broadcast producer.\n");
+    ERROR_ASSERT_PRINTF(getppid() == this->producer_pid, "The broadcast producer (pid %d) is gone.\n", this->producer_pid);
+};
+
+// =====================================================================
+void trace_broadcast_t::detach() {
+    if (this->consumer != BROADCAST_NO_CONSUMER) {
+        __atomic_store_n(&this->ring->consumed[this->consumer].value, BROADCAST_DETACHED, __ATOMIC_RELEASE);
+        this->consumer = BROADCAST_NO_CONSUMER;
+    }
+};
+
+// =====================================================================
+uint64_t trace_broadcast_t::slowest_consumed() {
+    uint64_t slowest = BROADCAST_DETACHED;
+    for (uint32_t i = 0; i < this->total_consumers; i++) {
+        uint64_t consumed = __atomic_load_n(&this->ring->consumed[i].value, __ATOMIC_ACQUIRE);
+        if (consumed < slowest) {
+            slowest = consumed;
+        }
+    }
+    return slowest;
+};
+
+// =====================================================================
+/// Detach the consumers whose process is gone, without reaping them
+void trace_broadcast_t::check_consumers() {
+    for (uint32_t i = 0; i < this->total_consumers; i++) {
+        if (this->consumer_pid[i] <= 0 || __atomic_load_n(&this->ring->consumed[i].value, __ATOMIC_ACQUIRE) == BROADCAST_DETACHED) {
+            continue;
+        }
+        siginfo_t info;
+        info.si_pid = 0;
+        if (waitid(P_PID, this->consumer_pid[i], &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid != 0) {
+            __atomic_store_n(&this->ring->consumed[i].value, BROADCAST_DETACHED, __ATOMIC_RELEASE);
+        }
+    }
+};
+
+// =====================================================================
+void trace_broadcast_t::produce() {
+    trace_reader_t *trace_reader = orcs_engine.trace_reader;
+    opcode_package_t instruction;
+    bool is_end = false;
+
+    while (!is_end) {
+        uint64_t produced = this->ring->produced.value;
+
+        /// Wait for the slowest consumer to release the oldest slot
+        uint64_t slowest = this->slowest_consumed();
+        if (slowest == BROADCAST_DETACHED) {
+            break;      /// Every consumer left
+        }
+        if (produced - slowest >= this->ring_batches) {
+            this->stat_full_waits++;
+            uint32_t spin = 0;
+            do {
+                trace_broadcast_wait(&spin);
+                if (spin == 0) {
+                    this->check_consumers();
+                }
+                slowest = this->slowest_consumed();
+            } while (slowest != BROADCAST_DETACHED && produced - slowest >= this->ring_batches);
+        }
+
+        trace_broadcast_batch_t *slot = &this->batch[produced % this->ring_batches];
+        uint32_t total = 0;
+        while (total < BROADCAST_BATCH_SIZE) {
+            uint32_t opcode = trace_reader->is_bbl_boundary() ? 0 : trace_reader->get_current_opcode();
+            if (!trace_reader->trace_fetch(&instruction)) {
+                is_end = true;
+                break;
+            }
+
+            trace_broadcast_entry_t *entry = &slot->entry[total++];
+            entry->bbl = trace_reader->get_current_bbl();
+            entry->opcode = opcode;
+            entry->read_address = instruction.read_address;
+            entry->read2_address = instruction.read2_address;
+            entry->write_address = instruction.write_address;
+            entry->read_size = instruction.read_size;
+            entry->read2_size = instruction.read2_size;
+            entry->write_size = instruction.write_size;
+        }
+        slot->total_entries = total;
+
+        if (total > 0) {
+            this->stat_batches++;
+            this->stat_instructions += total;
+            __atomic_store_n(&this->ring->produced.value, produced + 1, __ATOMIC_RELEASE);
+        }
+    }
+    __atomic_store_n(&this->ring->is_finished.value, 1, __ATOMIC_RELEASE);
+};
+
+// =====================================================================
+/// Release the batch just read and wait for the next one
+const trace_broadcast_entry_t *trace_broadcast_t::next_batch_entry() {
+    if (this->current_batch != NULL) {
+        __atomic_store_n(&this->ring->consumed[this->consumer].value, this->next_batch, __ATOMIC_RELEASE);
+        this->current_batch = NULL;
+    }
+
+    uint32_t spin = 0;
+    bool has_waited = false;
+    while (__atomic_load_n(&this->ring->produced.value, __ATOMIC_ACQUIRE) <= this->next_batch) {
+        if (__atomic_load_n(&this->ring->is_finished.value, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(&this->ring->produced.value, __ATOMIC_ACQUIRE) <= this->next_batch) {
+            this->detach();
+            return NULL;
+        }
+        has_waited = true;
+        trace_broadcast_wait(&spin);
+        if (spin == 0) {
+            ERROR_ASSERT_PRINTF(getppid() == this->producer_pid, "The broadcast producer (pid %d) is gone.\n", this->producer_pid);
+        }
+    }
+    this->stat_empty_waits += has_waited;
+
+    this->current_batch = &this->batch[this->next_batch % this->ring_batches];
+    this->next_batch++;
+    this->stat_batches++;
+    this->stat_instructions += this->current_batch->total_entries;
+    this->next_entry = 1;
+    return &this->current_batch->entry[0];
+};
+
+// =====================================================================
+void trace_broadcast_t::statistics() {
+    ORCS_PRINTF("######################################################\n");
+    ORCS_PRINTF("trace_broadcast_t\n");
+    ORCS_PRINTF("ring_batches:%u\n", this->ring_batches);
+    ORCS_PRINTF("batch_size:%u\n", BROADCAST_BATCH_SIZE);
+    ORCS_PRINTF("consumers:%u\n", this->total_consumers);
+    ORCS_PRINTF("batches:%" PRIu64 "\n", this->stat_batches);
+    ORCS_PRINTF("instructions:%" PRIu64 "\n", this->stat_instructions);
+    ORCS_PRINTF("full_waits:%" PRIu64 "\n", this->stat_full_waits);
+    ORCS_PRINTF("empty_waits:%" PRIu64 "\n", this->stat_empty_waits);
+};
@@ -0,0 +1,103 @@
+// ============================================================================
+// ============================================================================
+/// Decode-once broadcast of the trace to the forked configurations.
+/// With --broadcast the parent keeps the only decoding trace_reader_t:
+/// it publishes the instruction stream in batches on a ring shared with
+/// every child (MAP_SHARED, mapped before the fork), and each child's
+/// trace_fetch rebuilds the instructions from its own copy of the static
+/// dictionary instead of reading the gzip files. An entry is the BBL,
+/// the instruction inside it and the memory operands.
+///
+/// Each consumer publishes how many batches it finished; the producer
+/// only overwrites a slot once the slowest consumer is done with it, so
+/// it runs at most broadcast.ring_batches batches ahead (backpressure).
+/// Waits spin briefly and then yield the processor. A child that exits
+/// detaches itself; one killed by a signal is found by the producer
+/// (waitid with WNOWAIT, so fork_configs still collects its status).
+/// The children cannot finish without the producer: they are killed
+/// with it (PR_SET_PDEATHSIG), and also stop waiting once reparented.
+#define BROADCAST_BATCH_SIZE 1024           /// Instructions per batch
+#define BROADCAST_SPIN 256                  /// Polls before yielding
+#define BROADCAST_DETACHED UINT64_MAX       /// Consumer that left the ring
+#define BROADCAST_NO_CONSUMER UINT32_MAX
+
+// ============================================================================
+struct trace_broadcast_entry_t {
+    uint32_t bbl;
+    uint32_t opcode;                /// Position inside the BBL
+    uint64_t read_address;
+    uint64_t read2_address;
+    uint64_t write_address;
+    uint32_t read_size;
+    uint32_t read2_size;
+    uint32_t write_size;
+};
+
+struct trace_broadcast_batch_t {
+    uint32_t total_entries;
+    trace_broadcast_entry_t entry[BROADCAST_BATCH_SIZE];
+};
+
+/// Counters written by a single process, each on its own cache line
+struct trace_broadcast_counter_t {
+    uint64_t value;
+} __attribute__((aligned(64)));
+
+struct trace_broadcast_ring_t {
+    trace_broadcast_counter_t produced;                     /// Batches published
+    trace_broadcast_counter_t is_finished;
+    trace_broadcast_counter_t consumed[MAX_FORK_CONFIGS];   /// Batches finished by each consumer
+};
+
+// ============================================================================
+class trace_broadcast_t {
+    private:
+        trace_broadcast_ring_t *ring;
+        trace_broadcast_batch_t *batch;     /// ring_batches slots, after the ring header
+        uint64_t map_size;
+        uint32_t ring_batches;
+        uint32_t total_consumers;
+        pid_t consumer_pid[MAX_FORK_CONFIGS];   /// Producer side
+        pid_t producer_pid;
+
+        /// Consumer side, private to each process
+        uint32_t consumer;
+        uint64_t next_batch;
+        uint32_t next_entry;
+        const trace_broadcast_batch_t *current_batch;
+
+        uint64_t slowest_consumed();
+        void check_consumers();
+
+    public:
+        uint64_t stat_batches;
+        uint64_t stat_instructions;
+        uint64_t stat_full_waits;           /// Producer found the ring full
+        uint64_t stat_empty_waits;          /// Consumer found the ring empty
+
+        // ====================================================================
+        /// Methods
+        // ====================================================================
+        trace_broadcast_t();
+        ~trace_broadcast_t();
+        void allocate(uint32_t batches, uint32_t consumers);
+        void statistics();
+
+        /// Producer (parent): decode the whole trace into the ring
+        void set_consumer_pid(uint32_t consumer_index, pid_t pid) {
+            this->consumer_pid[consumer_index] = pid;
+        };
+        void produce();
+
+        /// Consumer (child)
+        void attach(uint32_t consumer_index);
+        void detach();
+        /// NULL at the end of the trace
+        const trace_broadcast_entry_t *next() {
+            if (this->current_batch != NULL && this->next_entry < this->current_batch->total_entries) {
+                return &this->current_batch->entry[this->next_entry++];
+            }
+            return this->next_batch_entry();
+        };
+        const trace_broadcast_entry_t *next_batch_entry();
+};
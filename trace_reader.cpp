@@ -13,65 +13,76 @@ trace_reader_t::~trace_reader_t() {
 };
 
 // =====================================================================
-void trace_reader_t::allocate(char *trace_file) {
+/// Open through a descriptor we own, so a forked child can re-attach
+/// the gzFile to a private descriptor (see detach_files)
+static gzFile trace_open(const char *file_name, int *file_descriptor) {
+    *file_descriptor = open(file_name, O_RDONLY);
+    if (*file_descriptor < 0) {
+        return NULL;
+    }
+    return gzdopen(*file_descriptor, "r");
+};
 
-    char file_name[TRACE_LINE_SIZE];
+// =====================================================================
+void trace_reader_t::allocate(char *trace_file) {
 
     // =================================================================
     /// Open the Static Trace File
     // =================================================================
-    file_name[0] = '\0';
-    snprintf(file_name, sizeof(file_name), "%s.tid%d.stat.out.gz", trace_file, 0);
-    DEBUG_PRINTF("Static File = %s => READY !\n", file_name);
-    this->gzStaticTraceFile = gzopen(file_name, "ro");    /// Open the .gz file
-    ERROR_ASSERT_PRINTF(gzStaticTraceFile != NULL, "Could not open the static file.\n%s\n", file_name);
-    DEBUG_PRINTF("Static File = %s => READY !\n", file_name);
+    snprintf(this->static_file_name, sizeof(this->static_file_name), "%s.tid%d.stat.out.gz", trace_file, 0);
+    this->gzStaticTraceFile = trace_open(this->static_file_name, &this->static_file_descriptor);    /// Open the .gz file
+    ERROR_ASSERT_PRINTF(gzStaticTraceFile != NULL, "Could not open the static file.\n%s\n", this->static_file_name);
+    DEBUG_PRINTF("Static File = %s => READY !\n", this->static_file_name);
 
     // =================================================================
     /// Open the Dynamic Trace File
     // =================================================================
-    file_name[0] = '\0';
-    snprintf(file_name, sizeof(file_name), "%s.tid%d.dyn.out.gz", trace_file, 0);
-    this->gzDynamicTraceFile = gzopen(file_name, "ro");    /// Open the .gz group
-    ERROR_ASSERT_PRINTF(this->gzDynamicTraceFile != NULL, "Could not open the dynamic file.\n%s\n", file_name);
-    DEBUG_PRINTF("Dynamic File = %s => READY !\n", file_name);
+    snprintf(this->dynamic_file_name, sizeof(this->dynamic_file_name), "%s.tid%d.dyn.out.gz", trace_file, 0);
+    this->gzDynamicTraceFile = trace_open(this->dynamic_file_name, &this->dynamic_file_descriptor);    /// Open the .gz group
+    ERROR_ASSERT_PRINTF(this->gzDynamicTraceFile != NULL, "Could not open the dynamic file.\n%s\n", this->dynamic_file_name);
+    DEBUG_PRINTF("Dynamic File = %s => READY !\n", this->dynamic_file_name);
 
     // =================================================================
     /// Open the Memory Trace File
     // =================================================================
-    file_name[0] = '\0';
-    snprintf(file_name, sizeof(file_name), "%s.tid%d.mem.out.gz", trace_file, 0);
-    this->gzMemoryTraceFile = gzopen(file_name, "ro");    /// Open the .gz group
-    ERROR_ASSERT_PRINTF(this->gzMemoryTraceFile != NULL, "Could not open the memory file.\n%s\n", file_name);
-    DEBUG_PRINTF("Memory File = %s => READY !\n", file_name);
+    snprintf(this->memory_file_name, sizeof(this->memory_file_name), "%s.tid%d.mem.out.gz", trace_file, 0);
+    this->gzMemoryTraceFile = trace_open(this->memory_file_name, &this->memory_file_descriptor);    /// Open the .gz group
+    ERROR_ASSERT_PRINTF(this->gzMemoryTraceFile != NULL, "Could not open the memory file.\n%s\n", this->memory_file_name);
+    DEBUG_PRINTF("Memory File = %s => READY !\n", this->memory_file_name);
 
     /// Set the trace_reader controls
     this->is_inside_bbl = false;
     this->currect_bbl = 0;
     this->currect_opcode = 0;
+    this->fetch_instructions = 0;
+    this->fetch_limit = UINT64_MAX;
+    this->broadcast = NULL;
 
 
 
 	/// Obtain the number of BBLs
 	this->get_total_bbls();
 
-	/// Allocate the vector of BBL sizes
-	this->binary_bbl_size = new uint32_t[this->binary_total_bbls];
-	ERROR_ASSERT_PRINTF(this->binary_bbl_size != NULL, "Could not allocate memory\n");
-	/// Initialize
-	for (uint32_t bbl = 0; bbl < this->binary_total_bbls; bbl++) {
-		this->binary_bbl_size[bbl] = 0;
-	};
+	/// The dictionary lives in one arena, the BBLs contiguous in order
+	this->dictionary_arena.allocate(ALLOCATION_TRACE_DICTIONARY);
+	this->assembly_strings.allocate(ALLOCATION_TRACE_STRINGS);
+
+	/// Allocate the vector of BBL sizes (zero filled)
+	this->binary_bbl_size = this->dictionary_arena.allocate_array<uint32_t>(this->binary_total_bbls);
 
 	/// Define the size of each specific BBL
 	this->define_binary_bbl_size();
 
 	/// Create the opcode for each BBL
-	this->binary_dict = new opcode_package_t*[this->binary_total_bbls];
-	ERROR_ASSERT_PRINTF(this->binary_dict != NULL, "Could not allocate memory\n");
+	uint64_t total_opcodes = 0;
+	for (uint32_t bbl = 1; bbl < this->binary_total_bbls; bbl++) {
+		total_opcodes += this->binary_bbl_size[bbl];
+	}
+	opcode_package_t *opcodes = this->dictionary_arena.allocate_array<opcode_package_t>(total_opcodes);
+	this->binary_dict = this->dictionary_arena.allocate_array<opcode_package_t*>(this->binary_total_bbls);
 	for (uint32_t bbl = 1; bbl < this->binary_total_bbls; bbl++) {
-		this->binary_dict[bbl] = new opcode_package_t[this->binary_bbl_size[bbl]];
-		ERROR_ASSERT_PRINTF(this->binary_dict[bbl] != NULL, "Could not allocate memory\n");
+		this->binary_dict[bbl] = opcodes;
+		opcodes += this->binary_bbl_size[bbl];
 	}
 
 	this->generate_binary_dict();
@@ -199,7 +210,7 @@ bool trace_reader_t::trace_string_to_opcode(char *input_string, opcode_package_t
     ERROR_ASSERT_PRINTF(count >= 13, "Error converting Text to Instruction (Wrong  number of fields %d), input_string = %s\n", count, input_string)
 
     sub_string = strtok_r(input_string, " ", &tmp_ptr);
-    strcpy(opcode->opcode_assembly, sub_string);
+    opcode->opcode_assembly = this->assembly_strings.intern(sub_string);
 
     sub_string = strtok_r(NULL, " ", &tmp_ptr);
     opcode->opcode_operation = instruction_operation_t(strtoul(sub_string, NULL, 10));
@@ -371,6 +382,13 @@ bool trace_reader_t::trace_fetch(opcode_package_t *m) {
     bool success;
     uint32_t new_BBL;
 
+    if (this->fetch_instructions >= this->fetch_limit) {
+        return FAIL;
+    }
+    if (this->broadcast != NULL) {
+        return this->broadcast_fetch(m);
+    }
+
     // =================================================================
     /// Fetch new BBL inside the dynamic file.
     // =================================================================
@@ -414,12 +432,12 @@ bool trace_reader_t::trace_fetch(opcode_package_t *m) {
     }
 
     if (m->is_read2) {
-        trace_next_memory(&m->read_address, &m->read_size, &mem_is_read);
+        trace_next_memory(&m->read2_address, &m->read2_size, &mem_is_read);
         ERROR_ASSERT_PRINTF(mem_is_read == true, "Expecting a read2 from memory trace\n");
     }
 
     if (m->is_write) {
-        trace_next_memory(&m->read_address, &m->read_size, &mem_is_read);
+        trace_next_memory(&m->write_address, &m->write_size, &mem_is_read);
         ERROR_ASSERT_PRINTF(mem_is_read == false, "Expecting a write from memory trace\n");
     }
 
@@ -427,6 +445,41 @@ bool trace_reader_t::trace_fetch(opcode_package_t *m) {
     return OK;
 };
 
+// =====================================================================
+/// Same instruction as trace_fetch would give, rebuilt from the local
+/// dictionary and the broadcast entry
+bool trace_reader_t::broadcast_fetch(opcode_package_t *m) {
+    const trace_broadcast_entry_t *entry = this->broadcast->next();
+    if (entry == NULL) {
+        ORCS_PRINTF("End of dynamic simulation trace\n");
+        return FAIL;
+    }
+
+    *m = this->binary_dict[entry->bbl][entry->opcode];
+    m->read_address = entry->read_address;
+    m->read_size = entry->read_size;
+    m->read2_address = entry->read2_address;
+    m->read2_size = entry->read2_size;
+    m->write_address = entry->write_address;
+    m->write_size = entry->write_size;
+
+    this->currect_bbl = entry->bbl;
+    this->fetch_instructions++;
+    return OK;
+};
+
+// =====================================================================
+/// Fast-forward: fetch and drop instructions, keeping the dynamic and
+/// memory streams aligned
+void trace_reader_t::trace_skip(uint64_t instructions) {
+    opcode_package_t skipped;
+    for (uint64_t i = 0; i < instructions; i++) {
+        if (!this->trace_fetch(&skipped)) {
+            break;
+        }
+    }
+};
+
 // =====================================================================
 void trace_reader_t::statistics() {
 	ORCS_PRINTF("######################################################\n");
@@ -436,3 +489,55 @@ void trace_reader_t::statistics() {
 };
 
 
+
+// =====================================================================
+/// Give this process a private descriptor for one trace file.
+/// After fork() parent and child share the descriptor offset, so the new
+/// descriptor starts at the same compressed offset and replaces the old one
+/// under the gzFile, which keeps its already inflated state.
+static void trace_detach_file(const char *file_name, int file_descriptor) {
+    off_t offset = lseek(file_descriptor, 0, SEEK_CUR);
+    ERROR_ASSERT_PRINTF(offset >= 0, "Could not obtain the trace offset.\n%s\n", file_name);
+
+    int new_descriptor = open(file_name, O_RDONLY);
+    ERROR_ASSERT_PRINTF(new_descriptor >= 0, "Could not reopen the trace file.\n%s\n", file_name);
+    ERROR_ASSERT_PRINTF(lseek(new_descriptor, offset, SEEK_SET) == offset, "Could not seek the trace file.\n%s\n", file_name);
+    ERROR_ASSERT_PRINTF(dup2(new_descriptor, file_descriptor) == file_descriptor, "Could not replace the trace descriptor.\n%s\n", file_name);
+    close(new_descriptor);
+};
+
+// =====================================================================
+void trace_reader_t::detach_files() {
+    trace_detach_file(this->static_file_name, this->static_file_descriptor);
+    trace_detach_file(this->dynamic_file_name, this->dynamic_file_descriptor);
+    trace_detach_file(this->memory_file_name, this->memory_file_descriptor);
+};
+
+// =====================================================================
+/// Save/Restore the stream positions and the in-BBL cursor.
+/// Positions are uncompressed offsets, restoring them inflates the trace
+/// up to the position, without parsing nor simulating it.
+void trace_reader_t::checkpoint(checkpoint_t *checkpoint) {
+    z_off_t dynamic_position = gztell(this->gzDynamicTraceFile);
+    z_off_t memory_position = gztell(this->gzMemoryTraceFile);
+    uint32_t total_bbls = this->binary_total_bbls;
+
+    checkpoint->section("TRCR");
+    checkpoint->transfer(&total_bbls);
+    checkpoint->transfer(&dynamic_position);
+    checkpoint->transfer(&memory_position);
+    checkpoint->transfer(&this->is_inside_bbl);
+    checkpoint->transfer(&this->currect_bbl);
+    checkpoint->transfer(&this->currect_opcode);
+    checkpoint->transfer(&this->fetch_instructions);
+
+    if (checkpoint->is_restoring()) {
+        ERROR_ASSERT_PRINTF(total_bbls == this->binary_total_bbls, "Checkpoint taken from a different static trace (%u BBLs, expected %u).\n", total_bbls, this->binary_total_bbls);
+        ERROR_ASSERT_PRINTF(this->currect_bbl < this->binary_total_bbls, "Checkpoint BBL %u out of the static trace.\n", this->currect_bbl);
+
+        gzclearerr(this->gzDynamicTraceFile);
+        ERROR_ASSERT_PRINTF(gzseek(this->gzDynamicTraceFile, dynamic_position, SEEK_SET) == dynamic_position, "Could not seek the dynamic file.\n");
+        gzclearerr(this->gzMemoryTraceFile);
+        ERROR_ASSERT_PRINTF(gzseek(this->gzMemoryTraceFile, memory_position, SEEK_SET) == memory_position, "Could not seek the memory file.\n");
+    }
+};
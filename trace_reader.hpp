@@ -6,6 +6,14 @@ class trace_reader_t {
         gzFile gzDynamicTraceFile;
         gzFile gzMemoryTraceFile;
 
+        /// Kept to reopen the files after fork()
+        char static_file_name[TRACE_LINE_SIZE];
+        char dynamic_file_name[TRACE_LINE_SIZE];
+        char memory_file_name[TRACE_LINE_SIZE];
+        int static_file_descriptor;
+        int dynamic_file_descriptor;
+        int memory_file_descriptor;
+
         /// Control the trace reading
         bool is_inside_bbl;
         uint32_t currect_bbl;
@@ -15,8 +23,15 @@ class trace_reader_t {
         uint32_t binary_total_bbls;     /// Total of BBLs for the static file
         uint32_t *binary_bbl_size;      /// Total of instructions for each BBL
         opcode_package_t **binary_dict; /// Complete dictionary of BBLs and instructions
+        arena_t dictionary_arena;       /// binary_bbl_size, binary_dict and the opcodes
+        string_table_t assembly_strings;
 
 		uint64_t fetch_instructions;
+		uint64_t fetch_limit;           /// trace_fetch stops at this instruction
+
+        /// Instructions come from the parent decoder instead of the files
+        trace_broadcast_t *broadcast;
+        bool broadcast_fetch(opcode_package_t *m);
 
     public:
         // ====================================================================
@@ -26,6 +41,11 @@ class trace_reader_t {
         ~trace_reader_t();
         void allocate(char *trace_file_name);
         void statistics();
+        void checkpoint(checkpoint_t *checkpoint);
+        void detach_files();
+        void attach_broadcast(trace_broadcast_t *trace_broadcast) {
+            this->broadcast = trace_broadcast;
+        };
 
         /// Generate the static dictionary
         void get_total_bbls();
@@ -36,6 +56,32 @@ class trace_reader_t {
         bool trace_next_dynamic(uint32_t *next_bbl);
         bool trace_next_memory(uint64_t *next_address, uint32_t *operation_size, bool *is_read);
         bool trace_fetch(opcode_package_t *m);
+        void trace_skip(uint64_t instructions);
+
+        void set_fetch_limit(uint64_t instruction) {
+            this->fetch_limit = instruction;
+        };
+
+        uint64_t get_fetch_instructions() {
+            return this->fetch_instructions;
+        };
+        uint32_t get_current_bbl() {
+            return this->currect_bbl;
+        };
+        /// Next instruction inside the current BBL
+        uint32_t get_current_opcode() {
+            return this->currect_opcode;
+        };
+        /// The next trace_fetch starts a new BBL
+        bool is_bbl_boundary() {
+            return !this->is_inside_bbl;
+        };
+        uint32_t get_binary_total_bbls() {
+            return this->binary_total_bbls;
+        };
+        uint32_t get_bbl_size(uint32_t bbl) {
+            return this->binary_bbl_size[bbl];
+        };
 };
 
 